@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TJAL_DECODE_SSE 1
+#endif
+
+// Decoders de accessor especializados em tempo de compilação: tipo do componente (T), componentes lidos (N),
+// normalização e layout da origem (compacto ou com byteStride). A escolha é feita uma vez por accessor
+// (GLTFLoader.cpp); o laço interno não tem nenhum desvio por componente.
+// Cobre FLOAT, BYTE/UBYTE/SHORT/USHORT normalizados ou não (KHR_mesh_quantization: posições, normais e UVs)
+
+// Escreve N floats por elemento em dst[i * dstStride]
+typedef void (*AccessorDecodeFn)(const unsigned char* src, size_t srcStride, float* dst, size_t dstStride, size_t count);
+
+// Conversão normalizada do glTF: unsigned c / max, signed max(c / max, -1)
+template <typename T, bool Normalized>
+inline float decodeComponent(T value) {
+    if (!Normalized || !std::numeric_limits<T>::is_integer) return static_cast<float>(value);
+    float scaled = static_cast<float>(value) * (1.0f / static_cast<float>(std::numeric_limits<T>::max()));
+    return std::numeric_limits<T>::is_signed ? std::max(scaled, -1.0f) : scaled;
+}
+
+// Packed = origem compacta: o passo vira constante (N * sizeof(T)) e o compilador desenrola/vetoriza o laço
+template <typename T, int N, bool Normalized, bool Packed>
+void decodeElements(const unsigned char* src, size_t srcStride, float* dst, size_t dstStride, size_t count) {
+    const size_t step = Packed ? N * sizeof(T) : srcStride;
+    // FLOAT compacto para destino compacto: cópia direta
+    if (Packed && !std::numeric_limits<T>::is_integer && sizeof(T) == sizeof(float) && dstStride == (size_t)N) {
+        std::memcpy(dst, src, count * N * sizeof(float));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i, src += step, dst += dstStride) {
+        T value[N];
+        std::memcpy(value, src, sizeof(value)); // byteStride pode deixar a origem desalinhada
+        for (int c = 0; c < N; ++c) dst[c] = decodeComponent<T, Normalized>(value[c]);
+    }
+}
+
+template <typename T, int N, bool Normalized>
+inline AccessorDecodeFn accessorDecoderFor(bool packed) {
+    return packed ? &decodeElements<T, N, Normalized, true> : &decodeElements<T, N, Normalized, false>;
+}
+
+template <typename T>
+inline AccessorDecodeFn accessorDecoderFor(int components, bool normalized, bool packed) {
+    switch (components) {
+        case 1: return normalized ? accessorDecoderFor<T, 1, true>(packed) : accessorDecoderFor<T, 1, false>(packed);
+        case 2: return normalized ? accessorDecoderFor<T, 2, true>(packed) : accessorDecoderFor<T, 2, false>(packed);
+        case 3: return normalized ? accessorDecoderFor<T, 3, true>(packed) : accessorDecoderFor<T, 3, false>(packed);
+        case 4: return normalized ? accessorDecoderFor<T, 4, true>(packed) : accessorDecoderFor<T, 4, false>(packed);
+        default: return nullptr;
+    }
+}
+
+// Índices compactos alargados para 32 bits
+template <typename T>
+inline void widenIndices(const unsigned char* src, size_t count, unsigned int* dst) {
+    if (sizeof(T) == sizeof(unsigned int)) {
+        std::memcpy(dst, src, count * sizeof(unsigned int));
+        return;
+    }
+    size_t i = 0;
+#ifdef TJAL_DECODE_SSE
+    // 16 índices (UBYTE) ou 8 (USHORT) por iteração, estendidos com zero
+    const __m128i zero = _mm_setzero_si128();
+    if (sizeof(T) == 2) {
+        for (; i + 8 <= count; i += 8) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(s, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(s, zero));
+        }
+    } else {
+        for (; i + 16 <= count; i += 16) {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i lo = _mm_unpacklo_epi8(s, zero), hi = _mm_unpackhi_epi8(s, zero);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        T value;
+        std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+        dst[i] = value;
+    }
+}
@@ -0,0 +1,227 @@
+#include "Animation.h"
+#include <algorithm>
+#include <cmath>
+
+// Passos lineares da busca de chave antes de cair na busca binária (saltos: setTime, volta do loop)
+static const unsigned kKeyScanSteps = 4;
+
+void decomposeTransform(const glm::mat4& local, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale) {
+    translation = glm::vec3(local[3]);
+    glm::mat3 basis(local);
+    scale = glm::vec3(glm::length(basis[0]), glm::length(basis[1]), glm::length(basis[2]));
+    if (glm::determinant(basis) < 0.0f) scale.x = -scale.x;
+    for (int c = 0; c < 3; ++c) {
+        if (scale[c] != 0.0f) basis[c] = basis[c] / scale[c];
+    }
+    rotation = glm::normalize(glm::quat_cast(basis));
+}
+
+glm::mat4 composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale) {
+    glm::mat4 local = glm::mat4_cast(rotation);
+    local[0] = local[0] * scale.x;
+    local[1] = local[1] * scale.y;
+    local[2] = local[2] * scale.z;
+    local[3] = glm::vec4(translation, 1.0f);
+    return local;
+}
+
+int AnimationSystem::addClips(const AnimationSet& set, const std::vector<int>& nodeMap, const SceneGraph& scene) {
+    int first = clipCount();
+    uint32_t timeBase = (uint32_t)times.size();
+    uint32_t valueBase = (uint32_t)values.size();
+    times.insert(times.end(), set.times.begin(), set.times.end());
+    values.insert(values.end(), set.values.begin(), set.values.end());
+
+    for (const AnimationClip& clip : set.clips) {
+        uint32_t firstChannel = (uint32_t)channelTargets.size();
+        for (uint32_t c = clip.firstChannel; c < clip.firstChannel + clip.channelCount; ++c) {
+            const AnimationChannel& channel = set.channels[c];
+            if (channel.node < 0 || channel.node >= (int)nodeMap.size() || nodeMap[channel.node] < 0) continue;
+            int node = nodeMap[channel.node];
+            int target;
+            auto found = targetByNode.find(node);
+            if (found != targetByNode.end()) {
+                target = found->second;
+            } else {
+                target = (int)targetNodes.size();
+                glm::vec3 translation, scale;
+                glm::quat rotation;
+                decomposeTransform(scene.local(node), translation, rotation, scale);
+                targetNodes.push_back(node);
+                targetTranslations.push_back(translation);
+                targetRotations.push_back(rotation);
+                targetScales.push_back(scale);
+                targetByNode[node] = target;
+            }
+            channelTargets.push_back(target);
+            channelPaths.push_back(channel.path);
+            channelInterpolations.push_back(channel.interpolation);
+            channelFirstKeys.push_back(timeBase + channel.firstKey);
+            channelKeyCounts.push_back(channel.keyCount);
+            channelFirstValues.push_back(valueBase + channel.firstValue);
+            channelLastKeys.push_back(0);
+        }
+        clipNames.push_back(clip.name);
+        clipDurations.push_back(clip.duration);
+        clipTimes.push_back(0.0f);
+        clipSpeeds.push_back(1.0f);
+        clipStopTimes.push_back(-1.0f);
+        clipPlaying.push_back(0);
+        clipLoops.push_back(0);
+        clipActive.push_back(0);
+        clipFirstChannels.push_back(firstChannel);
+        clipChannelCounts.push_back((uint32_t)channelTargets.size() - firstChannel);
+    }
+    return first;
+}
+
+void AnimationSystem::activate(int clip) {
+    if (clipActive[clip]) return;
+    clipActive[clip] = 1;
+    activeClips.push_back(clip);
+}
+
+void AnimationSystem::play(int clip, float speed, bool loop) {
+    // Sem loop, tocar de novo a partir da ponta final recomeça do outro lado
+    float duration = clipDurations[clip];
+    if (!loop && speed > 0.0f && clipTimes[clip] >= duration) clipTimes[clip] = 0.0f;
+    if (!loop && speed < 0.0f && clipTimes[clip] <= 0.0f) clipTimes[clip] = duration;
+    clipSpeeds[clip] = speed;
+    clipLoops[clip] = loop ? 1 : 0;
+    clipStopTimes[clip] = -1.0f;
+    clipPlaying[clip] = speed != 0.0f ? 1 : 0;
+    activate(clip);
+}
+
+void AnimationSystem::playTo(int clip, float stopTime, float speed) {
+    stopTime = std::min(std::max(stopTime, 0.0f), clipDurations[clip]);
+    float time = clipTimes[clip];
+    clipSpeeds[clip] = stopTime >= time ? std::abs(speed) : -std::abs(speed);
+    clipLoops[clip] = 0;
+    clipStopTimes[clip] = stopTime;
+    clipPlaying[clip] = (stopTime != time && speed != 0.0f) ? 1 : 0;
+    if (clipPlaying[clip]) activate(clip);
+}
+
+void AnimationSystem::stop(int clip) {
+    clipPlaying[clip] = 0;
+}
+
+void AnimationSystem::setTime(int clip, float time) {
+    clipTimes[clip] = std::min(std::max(time, 0.0f), clipDurations[clip]);
+    activate(clip);
+}
+
+void AnimationSystem::advance(float deltaTime) {
+    lastChannelsEvaluated = 0;
+    for (size_t a = 0; a < activeClips.size();) {
+        int clip = activeClips[a];
+        float time = clipTimes[clip];
+        if (clipPlaying[clip]) {
+            float speed = clipSpeeds[clip];
+            float duration = clipDurations[clip];
+            float stopTime = clipStopTimes[clip];
+            time += deltaTime * speed;
+            if (stopTime >= 0.0f && (speed > 0.0f ? time >= stopTime : time <= stopTime)) {
+                time = stopTime;
+                clipPlaying[clip] = 0;
+            } else if (clipLoops[clip] && duration > 0.0f) {
+                time = std::fmod(time, duration);
+                if (time < 0.0f) time += duration;
+            } else if (time >= duration || time <= 0.0f) {
+                time = std::min(std::max(time, 0.0f), duration);
+                clipPlaying[clip] = 0;
+            }
+            clipTimes[clip] = time;
+        }
+        uint32_t first = clipFirstChannels[clip], count = clipChannelCounts[clip];
+        for (uint32_t c = first; c < first + count; ++c) sampleChannel(c, time);
+        lastChannelsEvaluated += count;
+        // Parado: a pose final já foi amostrada, sai da lista ativa
+        if (!clipPlaying[clip]) {
+            clipActive[clip] = 0;
+            activeClips[a] = activeClips.back();
+            activeClips.pop_back();
+        } else {
+            ++a;
+        }
+    }
+}
+
+void AnimationSystem::copyPoses(std::vector<NodePose>& out) const {
+    out.resize(targetNodes.size());
+    for (size_t target = 0; target < targetNodes.size(); ++target) {
+        NodePose& pose = out[target];
+        pose.node = targetNodes[target];
+        pose.translation = targetTranslations[target];
+        pose.rotation = targetRotations[target];
+        pose.scale = targetScales[target];
+    }
+}
+
+void AnimationSystem::sampleChannel(uint32_t channel, float time) {
+    const float* keys = times.data() + channelFirstKeys[channel];
+    uint32_t count = channelKeyCounts[channel];
+    if (count == 0) return;
+
+    // Segmento k: keys[k] <= time < keys[k + 1]. Começa do segmento da amostra anterior; entre quadros o tempo
+    // anda no máximo algumas chaves (para frente ou para trás), saltos maiores usam busca binária
+    uint32_t k = std::min(channelLastKeys[channel], count - 1);
+    unsigned steps = 0;
+    if (time < keys[k]) {
+        while (k > 0 && time < keys[k] && steps++ < kKeyScanSteps) --k;
+        if (time < keys[k]) {
+            k = (uint32_t)(std::upper_bound(keys, keys + k, time) - keys);
+            k = k > 0 ? k - 1 : 0;
+        }
+    } else {
+        while (k + 1 < count && time >= keys[k + 1] && steps++ < kKeyScanSteps) ++k;
+        if (k + 1 < count && time >= keys[k + 1]) {
+            k = (uint32_t)(std::upper_bound(keys + k + 1, keys + count, time) - keys) - 1;
+        }
+    }
+    channelLastKeys[channel] = k;
+
+    const AnimationPath path = (AnimationPath)channelPaths[channel];
+    const AnimationInterpolation interpolation = (AnimationInterpolation)channelInterpolations[channel];
+    const int components = path == AnimationPath::Rotation ? 4 : 3;
+    const bool cubic = interpolation == AnimationInterpolation::CubicSpline;
+    const size_t keyStride = cubic ? 3 * components : components; // CUBICSPLINE: (entrada, valor, saída)
+    const float* base = values.data() + channelFirstValues[channel];
+    const float* v0 = base + k * keyStride + (cubic ? components : 0);
+
+    float out[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    if (k + 1 >= count || time <= keys[0] || interpolation == AnimationInterpolation::Step) {
+        // Antes da primeira chave, depois da última, ou STEP: valor da chave
+        std::copy(v0, v0 + components, out);
+    } else {
+        const float* v1 = v0 + keyStride;
+        float span = keys[k + 1] - keys[k];
+        float u = span > 0.0f ? (time - keys[k]) / span : 0.0f;
+        if (cubic) {
+            // Hermite com as tangentes escaladas pelo intervalo (especificação glTF, apêndice C)
+            const float* outTangent = v0 + components;
+            const float* inTangent = v1 - components;
+            float u2 = u * u, u3 = u2 * u;
+            float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f, h10 = (u3 - 2.0f * u2 + u) * span;
+            float h01 = -2.0f * u3 + 3.0f * u2, h11 = (u3 - u2) * span;
+            for (int c = 0; c < components; ++c) {
+                out[c] = h00 * v0[c] + h10 * outTangent[c] + h01 * v1[c] + h11 * inTangent[c];
+            }
+        } else if (path == AnimationPath::Rotation) {
+            glm::quat q = glm::slerp(glm::quat(v0[3], v0[0], v0[1], v0[2]), glm::quat(v1[3], v1[0], v1[1], v1[2]), u);
+            out[0] = q.x; out[1] = q.y; out[2] = q.z; out[3] = q.w;
+        } else {
+            for (int c = 0; c < components; ++c) out[c] = v0[c] + (v1[c] - v0[c]) * u;
+        }
+    }
+
+    int target = channelTargets[channel];
+    switch (path) {
+        case AnimationPath::Translation: targetTranslations[target] = glm::vec3(out[0], out[1], out[2]); break;
+        case AnimationPath::Rotation:
+            targetRotations[target] = glm::normalize(glm::quat(out[3], out[0], out[1], out[2]));
+            break;
+        case AnimationPath::Scale: targetScales[target] = glm::vec3(out[0], out[1], out[2]); break;
+    }
+}
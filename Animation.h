@@ -0,0 +1,128 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SceneGraph.h"
+
+// Animações de nós (glTF animations: translation/rotation/scale). Os keyframes ficam em dois arrays de float
+// compartilhados (tempos e valores); cada canal é uma faixa deles. Pesos de morph targets não são suportados
+enum class AnimationPath : uint8_t { Translation = 0, Rotation = 1, Scale = 2 };
+enum class AnimationInterpolation : uint8_t { Step = 0, Linear = 1, CubicSpline = 2 };
+
+// Layout fixo: vai direto para o arquivo cozido
+struct AnimationChannel {
+    int32_t node = -1;              // nó do asset (no AnimationSet) ou da cena (no AnimationSystem)
+    uint8_t path = 0;               // AnimationPath
+    uint8_t interpolation = 0;      // AnimationInterpolation
+    uint16_t reserved = 0;
+    uint32_t firstKey = 0;          // em times
+    uint32_t keyCount = 0;
+    uint32_t firstValue = 0;        // em values: keyCount elementos de 3 (T, S) ou 4 (R, xyzw) floats;
+                                    // CUBICSPLINE guarda 3 por chave: tangente de entrada, valor, tangente de saída
+};
+
+struct AnimationClip {
+    std::string name;
+    float duration = 0.0f;          // maior tempo de chave dos canais
+    uint32_t firstChannel = 0;
+    uint32_t channelCount = 0;
+};
+
+// Animações de um asset, como importadas/cozidas
+struct AnimationSet {
+    std::vector<AnimationClip> clips;
+    std::vector<AnimationChannel> channels;
+    std::vector<float> times;
+    std::vector<float> values;
+    bool empty() const { return clips.empty(); }
+};
+
+// local = T * R * S (sem cisalhamento, como exige o glTF para nós animados); espelhamento vai no sinal de S.x
+void decomposeTransform(const glm::mat4& local, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale);
+glm::mat4 composeTransform(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
+// Pose local de um nó animado (copiada para fora do sistema, ex.: snapshot da thread de simulação)
+struct NodePose {
+    int node = -1;
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// Reprodução de clipes sobre o grafo de cena. Todos os canais dos clipes ativos são avaliados juntos em
+// advance(): a busca da chave começa do índice da chamada anterior (tempo avança pouco entre passos: O(1)
+// amortizado). O grafo não é tocado aqui: a pose de cada nó animado (T, R, S) sai por copyPoses no snapshot
+// da simulação e vira uma única setLocal por quadro na thread do GL
+class AnimationSystem {
+public:
+    // Copia os clipes de set com os canais apontando para nodeMap[nó do set] (nós da cena). A pose de repouso
+    // de cada nó animado (componentes sem canal) vem da local atual no grafo. Retorna o índice do primeiro clipe
+    int addClips(const AnimationSet& set, const std::vector<int>& nodeMap, const SceneGraph& scene);
+
+    int clipCount() const { return (int)clipNames.size(); }
+    const std::string& clipName(int clip) const { return clipNames[clip]; }
+    float clipDuration(int clip) const { return clipDurations[clip]; }
+    float clipTime(int clip) const { return clipTimes[clip]; }
+    bool isPlaying(int clip) const { return clipPlaying[clip] != 0; }
+
+    // Toca do tempo atual; speed < 0 toca para trás. Com loop o tempo dá a volta, sem loop para na ponta
+    void play(int clip, float speed = 1.0f, bool loop = false);
+    // Toca do tempo atual até stopTime (na direção necessária, |speed|) e para lá
+    void playTo(int clip, float stopTime, float speed);
+    void stop(int clip);
+    // Posiciona o clipe; a pose é amostrada no próximo advance
+    void setTime(int clip, float time);
+
+    // Avança os clipes ativos e amostra seus canais (só estado interno: pode rodar fora da thread do grafo)
+    void advance(float deltaTime);
+    // Pose de todos os nós animados (índice = alvo, em ordem de criação)
+    void copyPoses(std::vector<NodePose>& out) const;
+
+    size_t activeClipCount() const { return activeClips.size(); }
+    size_t channelsEvaluated() const { return lastChannelsEvaluated; }
+
+private:
+    void activate(int clip);
+    void sampleChannel(uint32_t channel, float time);
+
+    // Keyframes de todos os clipes
+    std::vector<float> times;
+    std::vector<float> values;
+
+    // Canais (SoA); channelTargets indexa os arrays de alvos
+    std::vector<int> channelTargets;
+    std::vector<uint8_t> channelPaths;
+    std::vector<uint8_t> channelInterpolations;
+    std::vector<uint32_t> channelFirstKeys;
+    std::vector<uint32_t> channelKeyCounts;
+    std::vector<uint32_t> channelFirstValues;
+    std::vector<uint32_t> channelLastKeys; // chave da última amostra (início da busca seguinte)
+
+    // Clipes (SoA)
+    std::vector<std::string> clipNames;
+    std::vector<float> clipDurations;
+    std::vector<float> clipTimes;
+    std::vector<float> clipSpeeds;
+    std::vector<float> clipStopTimes;     // < 0: sem parada marcada
+    std::vector<uint8_t> clipPlaying;
+    std::vector<uint8_t> clipLoops;
+    std::vector<uint8_t> clipActive;      // está em activeClips (tocando ou com pose pendente)
+    std::vector<uint32_t> clipFirstChannels;
+    std::vector<uint32_t> clipChannelCounts;
+    std::vector<int> activeClips;
+
+    // Nós animados (alvos): pose atual em T, R, S
+    std::vector<int> targetNodes;
+    std::vector<glm::vec3> targetTranslations;
+    std::vector<glm::quat> targetRotations;
+    std::vector<glm::vec3> targetScales;
+    std::unordered_map<int, int> targetByNode;
+
+    size_t lastChannelsEvaluated = 0;
+};
@@ -1,13 +1,22 @@
 #include "GLTFRenderer.h"
 
-void GLTFRenderer::updateCameraVectors() {
-    glm::vec3 front;
+static void cameraAxes(float yaw, float pitch, glm::vec3& front, glm::vec3& right, glm::vec3& up) {
     front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
     front.y = sin(glm::radians(pitch));
     front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-    cameraFront = glm::normalize(front);
-    cameraRight = glm::normalize(glm::cross(cameraFront, glm::vec3(0.0f, 1.0f, 0.0f)));
-    cameraUp = glm::normalize(glm::cross(cameraRight, cameraFront));
+    front = glm::normalize(front);
+    right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+    up = glm::normalize(glm::cross(right, front));
+}
+
+glm::mat4 cameraViewMatrix(const glm::vec3& position, float yaw, float pitch) {
+    glm::vec3 front, right, up;
+    cameraAxes(yaw, pitch, front, right, up);
+    return glm::lookAt(position, position + front, up);
+}
+
+void GLTFRenderer::updateCameraVectors() {
+    cameraAxes(yaw, pitch, cameraFront, cameraRight, cameraUp);
 }
 
 void GLTFRenderer::updateCameraView() {
@@ -45,18 +54,19 @@ void GLTFRenderer::processMovement(int direction, float deltaTime) {
     }
     
     cameraPos = newPos;
+    // Altura do chão: followGround, uma vez por passo da simulação (não uma vez por tecla)
+    updateCameraView();
+}
 
+void GLTFRenderer::followGround(float deltaTime) {
     // Ajustar altura com base no piso/escada no ponto atual apenas se não estiver em modo de movimento vertical livre
-    if (!freeVerticalMovement) {
-        float groundY = groundHeightAt(cameraPos);
-        // Suavizar para evitar "quebras" na borda da escada
-        if (lastGroundY == 0.0f) lastGroundY = groundY;
-        float blended = glm::mix(lastGroundY, groundY, groundFollowLerp);
-        lastGroundY = blended;
-        cameraPos.y = blended + walkHeight; // olho a uma altura fixa acima do chão/escada
-    }
-        
-    // Atualizar a view matrix
+    if (freeVerticalMovement) return;
+    float groundY = groundHeightAt(cameraPos);
+    // Suavizar para evitar "quebras" na borda da escada; a fração depende do tempo, não do número de quadros
+    if (lastGroundY == 0.0f) lastGroundY = groundY;
+    float blended = glm::mix(lastGroundY, groundY, 1.0f - std::exp(-groundFollowRate * deltaTime));
+    lastGroundY = blended;
+    cameraPos.y = blended + walkHeight; // olho a uma altura fixa acima do chão/escada
     updateCameraView();
 }
 
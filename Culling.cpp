@@ -0,0 +1,334 @@
+#include "GLTFRenderer.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TJAL_CULL_SSE 1
+#endif
+
+// Quantas instâncias no máximo por folha da BVH
+static const int kBVHLeafSize = 4;
+// Abaixo disso o percurso fica numa thread só (jobs custariam mais do que economizam)
+static const size_t kParallelCullMinInstances = 4096;
+// Subárvores por thread no culling paralelo (sobra para o roubo equilibrar lados vazios do frustum)
+static const size_t kCullTasksPerThread = 4;
+
+AABB transformAABB(const glm::mat4& m, const glm::vec3& localMin, const glm::vec3& localMax) {
+    // Centro/extensão (Arvo): c' = M*c, e' = |M|*e
+    glm::vec3 center = (localMin + localMax) * 0.5f;
+    glm::vec3 extent = (localMax - localMin) * 0.5f;
+    glm::vec3 c = glm::vec3(m * glm::vec4(center, 1.0f));
+    glm::vec3 e;
+    for (int r = 0; r < 3; ++r) {
+        e[r] = std::abs(m[0][r]) * extent.x + std::abs(m[1][r]) * extent.y + std::abs(m[2][r]) * extent.z;
+    }
+    AABB out;
+    out.min = c - e;
+    out.max = c + e;
+    return out;
+}
+
+static void allPassFrustum(Frustum& f) {
+    for (int i = 0; i < 8; ++i) {
+        f.nx[i] = 0.0f; f.ny[i] = 0.0f; f.nz[i] = 0.0f; f.d[i] = 1.0f;
+    }
+}
+
+static void extractFrustum(const glm::mat4& viewProj, Frustum& f) {
+    // Gribb/Hartmann: linhas da matriz viewProj (glm é column-major)
+    auto row = [&](int r) { return glm::vec4(viewProj[0][r], viewProj[1][r], viewProj[2][r], viewProj[3][r]); };
+    glm::vec4 r0 = row(0), r1 = row(1), r2 = row(2), r3 = row(3);
+    glm::vec4 planes[6] = { r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2 };
+    for (int i = 0; i < 8; ++i) {
+        if (i < 6) {
+            f.nx[i] = planes[i].x; f.ny[i] = planes[i].y; f.nz[i] = planes[i].z; f.d[i] = planes[i].w;
+        } else {
+            // Planos de preenchimento: sempre "dentro"
+            f.nx[i] = 0.0f; f.ny[i] = 0.0f; f.nz[i] = 0.0f; f.d[i] = 1.0f;
+        }
+    }
+}
+
+// 0 = fora, 1 = cruza, 2 = totalmente dentro
+int classifyAABB(const Frustum& f, const AABB& b) {
+#ifdef TJAL_CULL_SSE
+    // 4 planos por iteração: vértice positivo (p) decide "fora", negativo (n) decide "cruza"
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minX = _mm_set1_ps(b.min.x), minY = _mm_set1_ps(b.min.y), minZ = _mm_set1_ps(b.min.z);
+    const __m128 maxX = _mm_set1_ps(b.max.x), maxY = _mm_set1_ps(b.max.y), maxZ = _mm_set1_ps(b.max.z);
+    int crossing = 0;
+    for (int k = 0; k < 8; k += 4) {
+        __m128 nx = _mm_load_ps(f.nx + k), ny = _mm_load_ps(f.ny + k), nz = _mm_load_ps(f.nz + k);
+        __m128 d = _mm_load_ps(f.d + k);
+        __m128 sx = _mm_cmpgt_ps(nx, zero), sy = _mm_cmpgt_ps(ny, zero), sz = _mm_cmpgt_ps(nz, zero);
+        __m128 px = _mm_or_ps(_mm_and_ps(sx, maxX), _mm_andnot_ps(sx, minX));
+        __m128 py = _mm_or_ps(_mm_and_ps(sy, maxY), _mm_andnot_ps(sy, minY));
+        __m128 pz = _mm_or_ps(_mm_and_ps(sz, maxZ), _mm_andnot_ps(sz, minZ));
+        __m128 qx = _mm_or_ps(_mm_and_ps(sx, minX), _mm_andnot_ps(sx, maxX));
+        __m128 qy = _mm_or_ps(_mm_and_ps(sy, minY), _mm_andnot_ps(sy, maxY));
+        __m128 qz = _mm_or_ps(_mm_and_ps(sz, minZ), _mm_andnot_ps(sz, maxZ));
+        __m128 distP = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, px), _mm_mul_ps(ny, py)), _mm_add_ps(_mm_mul_ps(nz, pz), d));
+        if (_mm_movemask_ps(_mm_cmplt_ps(distP, zero))) return 0;
+        __m128 distN = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, qx), _mm_mul_ps(ny, qy)), _mm_add_ps(_mm_mul_ps(nz, qz), d));
+        crossing |= _mm_movemask_ps(_mm_cmplt_ps(distN, zero));
+    }
+    return crossing ? 1 : 2;
+#else
+    bool crossing = false;
+    for (int i = 0; i < 6; ++i) {
+        float px = f.nx[i] > 0.0f ? b.max.x : b.min.x;
+        float py = f.ny[i] > 0.0f ? b.max.y : b.min.y;
+        float pz = f.nz[i] > 0.0f ? b.max.z : b.min.z;
+        if (f.nx[i] * px + f.ny[i] * py + f.nz[i] * pz + f.d[i] < 0.0f) return 0;
+        float qx = f.nx[i] > 0.0f ? b.min.x : b.max.x;
+        float qy = f.ny[i] > 0.0f ? b.min.y : b.max.y;
+        float qz = f.nz[i] > 0.0f ? b.min.z : b.max.z;
+        if (f.nx[i] * qx + f.ny[i] * qy + f.nz[i] * qz + f.d[i] < 0.0f) crossing = true;
+    }
+    return crossing ? 1 : 2;
+#endif
+}
+
+static void mergeAABB(AABB& into, const AABB& b) {
+    into.min = glm::min(into.min, b.min);
+    into.max = glm::max(into.max, b.max);
+}
+
+void GLTFRenderer::buildBVH() {
+    bvhNodes.clear();
+    bvhItems.resize(instances.size());
+    instanceLeaf.assign(instances.size(), -1);
+    // Uma árvore por grupo: instâncias globais + uma por sala (descartadas inteiras pelos portais)
+    assignRooms();
+    bvhRoots.assign(rooms.size() + 1, -1);
+    if (instances.empty()) { bvhDirty = false; return; }
+
+    std::vector<glm::vec3> centroids(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        bvhItems[i] = (int)i;
+        centroids[i] = (instanceBounds[i].min + instanceBounds[i].max) * 0.5f;
+    }
+    std::stable_sort(bvhItems.begin(), bvhItems.end(), [&](int a, int b) { return instanceRoom[a] < instanceRoom[b]; });
+    bvhNodes.reserve(2 * instances.size() / kBVHLeafSize + 2 * bvhRoots.size());
+    size_t first = 0;
+    while (first < bvhItems.size()) {
+        int group = instanceRoom[bvhItems[first]] + 1;
+        size_t end = first;
+        while (end < bvhItems.size() && instanceRoom[bvhItems[end]] + 1 == group) ++end;
+        bvhRoots[group] = buildBVHNode((int)first, (int)(end - first), centroids, -1);
+        first = end;
+    }
+    bvhDirty = false;
+    std::cout << "BVH construída: " << bvhNodes.size() << " nós para " << instances.size() << " instâncias" << std::endl;
+}
+
+int GLTFRenderer::buildBVHNode(int first, int count, const std::vector<glm::vec3>& centroids, int parent) {
+    int nodeIndex = (int)bvhNodes.size();
+    bvhNodes.emplace_back();
+    bvhNodes[nodeIndex].parent = parent;
+
+    AABB bounds, centroidBounds;
+    for (int i = first; i < first + count; ++i) {
+        mergeAABB(bounds, instanceBounds[bvhItems[i]]);
+        centroidBounds.min = glm::min(centroidBounds.min, centroids[bvhItems[i]]);
+        centroidBounds.max = glm::max(centroidBounds.max, centroids[bvhItems[i]]);
+    }
+    bvhNodes[nodeIndex].bounds = bounds;
+
+    if (count <= kBVHLeafSize) {
+        bvhNodes[nodeIndex].first = first;
+        bvhNodes[nodeIndex].count = count;
+        for (int i = first; i < first + count; ++i) instanceLeaf[bvhItems[i]] = nodeIndex;
+        return nodeIndex;
+    }
+
+    // Divisão pela mediana no eixo de maior extensão dos centróides
+    glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+    int mid = first + count / 2;
+    std::nth_element(bvhItems.begin() + first, bvhItems.begin() + mid, bvhItems.begin() + first + count,
+                     [&](int a, int b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    int left = buildBVHNode(first, mid - first, centroids, nodeIndex);
+    int right = buildBVHNode(mid, first + count - mid, centroids, nodeIndex);
+    bvhNodes[nodeIndex].left = left;
+    bvhNodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+void GLTFRenderer::refitInstance(int instanceIndex) {
+    const auto& inst = instances[instanceIndex];
+    const auto& mesh = meshes[inst.meshIndex];
+    setInstanceTransform(instanceIndex, instanceWorldMatrix(instanceIndex));
+    instanceBounds[instanceIndex] = transformAABB(worldTransforms[instanceIndex], mesh.localMin, mesh.localMax);
+    if (bvhDirty || instanceIndex >= (int)instanceLeaf.size()) return; // será reconstruída no próximo frame
+
+    // Recalcular a folha e subir atualizando os pais
+    int node = instanceLeaf[instanceIndex];
+    AABB leafBounds;
+    for (int i = bvhNodes[node].first; i < bvhNodes[node].first + bvhNodes[node].count; ++i) {
+        mergeAABB(leafBounds, instanceBounds[bvhItems[i]]);
+    }
+    bvhNodes[node].bounds = leafBounds;
+    for (node = bvhNodes[node].parent; node >= 0; node = bvhNodes[node].parent) {
+        AABB merged = bvhNodes[bvhNodes[node].left].bounds;
+        mergeAABB(merged, bvhNodes[bvhNodes[node].right].bounds);
+        bvhNodes[node].bounds = merged;
+    }
+}
+
+void GLTFRenderer::cullInstances() {
+    visibleInstances.clear();
+    if (instances.empty()) return;
+    if (bvhDirty) buildBVH();
+
+    Frustum frustum;
+    if (frustumCullingEnabled) {
+        extractFrustum(projection * frameState.view * model, frustum);
+    } else {
+        allPassFrustum(frustum);
+    }
+    cullFrustum = frustum;
+
+    // Salas atrás de portas fechadas são descartadas antes de qualquer teste por mesh
+    computeVisibleRooms(frustum);
+    if (instances.size() >= kParallelCullMinInstances && jobSystem().threadCount() > 0) {
+        cullBVHParallel(frustum);
+    } else {
+        cullBVH(bvhRoots[0], false, frustum, visibleInstances);
+        for (size_t r = 0; r < rooms.size(); ++r) {
+            if (visibleRooms[r]) cullBVH(bvhRoots[r + 1], false, frustum, visibleInstances);
+        }
+    }
+    // Por último, o que as consultas do frame anterior mostraram estar escondido
+    applyOcclusion();
+}
+
+void GLTFRenderer::cullBVH(int root, bool rootInside, const Frustum& frustum, std::vector<int>& out) const {
+    if (root < 0) return;
+    // Percurso com pilha explícita; subárvores totalmente dentro dispensam novos testes
+    struct StackEntry { int node; bool inside; };
+    StackEntry stack[64];
+    int top = 0;
+    stack[top++] = {root, rootInside};
+    while (top > 0) {
+        StackEntry entry = stack[--top];
+        const BVHNode& node = bvhNodes[entry.node];
+        bool inside = entry.inside;
+        if (!inside) {
+            int c = classifyAABB(frustum, node.bounds);
+            if (c == 0) continue;
+            inside = (c == 2);
+        }
+        if (node.left < 0) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                int item = bvhItems[i];
+                if (inside || classifyAABB(frustum, instanceBounds[item]) != 0) {
+                    out.push_back(item);
+                }
+            }
+        } else {
+            stack[top++] = {node.left, inside};
+            stack[top++] = {node.right, inside};
+        }
+    }
+}
+
+void GLTFRenderer::cullBVHParallel(const Frustum& frustum) {
+    // Topo das árvores aberto em largura aqui (descartando o que já cai fora) até haver subárvores para
+    // todas as threads; cada subárvore vira um job com sua lista, concatenada na ordem das tarefas
+    JobSystem& pool = jobSystem();
+    size_t wanted = kCullTasksPerThread * (pool.threadCount() + 1);
+    cullTasks.clear();
+    if (bvhRoots[0] >= 0) cullTasks.push_back({bvhRoots[0], false});
+    for (size_t r = 0; r < rooms.size(); ++r) {
+        if (visibleRooms[r] && bvhRoots[r + 1] >= 0) cullTasks.push_back({bvhRoots[r + 1], false});
+    }
+    bool expanded = true;
+    while (expanded && cullTasks.size() < wanted) {
+        expanded = false;
+        cullTasksNext.clear();
+        for (const CullTask& task : cullTasks) {
+            const BVHNode& node = bvhNodes[task.node];
+            bool inside = task.inside;
+            if (!inside) {
+                int c = classifyAABB(frustum, node.bounds);
+                if (c == 0) continue;
+                inside = (c == 2);
+            }
+            if (node.left < 0) {
+                cullTasksNext.push_back({task.node, inside});
+            } else {
+                cullTasksNext.push_back({node.left, inside});
+                cullTasksNext.push_back({node.right, inside});
+                expanded = true;
+            }
+        }
+        cullTasks.swap(cullTasksNext);
+    }
+
+    if (cullOutputs.size() < cullTasks.size()) cullOutputs.resize(cullTasks.size());
+    pool.parallelFor(cullTasks.size(), [&](size_t t) {
+        cullOutputs[t].clear();
+        cullBVH(cullTasks[t].node, cullTasks[t].inside, frustum, cullOutputs[t]);
+    });
+    for (size_t t = 0; t < cullTasks.size(); ++t) {
+        visibleInstances.insert(visibleInstances.end(), cullOutputs[t].begin(), cullOutputs[t].end());
+    }
+}
+
+bool GLTFRenderer::appendVisibleClusters(int instanceIndex, MultiDrawGroup& group) {
+    // Clusters do nível completo testados um a um (frustum e cone de normais) e anexados ao multi-draw do grupo.
+    // Retorna false quando o mesh não tem clusters (o chamador desenha a faixa inteira)
+    const MeshInstance& inst = instances[instanceIndex];
+    const Mesh& mesh = meshes[inst.meshIndex];
+    if (!clusterCullingEnabled || mesh.clusters.empty() || inst.lod != 0) return false;
+    const glm::mat4& world = worldTransforms[instanceIndex];
+    glm::mat3 normalMatrix(normalTransforms[instanceIndex]);
+    // O cone só vale com escala uniforme (escala não uniforme muda os ângulos entre as normais)
+    float sx = glm::length(glm::vec3(world[0])), sy = glm::length(glm::vec3(world[1])), sz = glm::length(glm::vec3(world[2]));
+    float maxScale = std::max(sx, std::max(sy, sz)), minScale = std::min(sx, std::min(sy, sz));
+    bool coneTest = !mesh.doubleSided && maxScale - minScale <= maxScale * 1e-3f;
+    size_t indexBytes = mesh.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+
+    for (const MeshCluster& cluster : mesh.clusters) {
+        stats.clustersTested++;
+        glm::vec3 localMin(cluster.boundsMin[0], cluster.boundsMin[1], cluster.boundsMin[2]);
+        glm::vec3 localMax(cluster.boundsMax[0], cluster.boundsMax[1], cluster.boundsMax[2]);
+        AABB bounds = transformAABB(world, localMin, localMax);
+        if (classifyAABB(cullFrustum, bounds) == 0) {
+            stats.clustersCulled++;
+            continue;
+        }
+        if (coneTest && cluster.coneCutoff <= 1.0f) {
+            glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+            float radius = glm::length(localMax - localMin) * 0.5f * maxScale;
+            glm::vec3 axis = glm::normalize(normalMatrix * glm::vec3(cluster.coneAxis[0], cluster.coneAxis[1], cluster.coneAxis[2]));
+            glm::vec3 toCluster = center - frameState.cameraPos;
+            if (glm::dot(toCluster, axis) >= cluster.coneCutoff * glm::length(toCluster) + radius) {
+                stats.clustersCulled++;
+                continue;
+            }
+        }
+        // Clusters vizinhos no arquivo viram uma única faixa
+        size_t offset = mesh.indexOffset + cluster.firstIndex * indexBytes;
+        if (!group.counts.empty() && group.baseVertices.back() == mesh.baseVertex &&
+            (size_t)group.indexOffsets.back() + group.counts.back() * indexBytes == offset) {
+            group.counts.back() += (GLsizei)cluster.indexCount;
+        } else {
+            group.counts.push_back((GLsizei)cluster.indexCount);
+            group.indexOffsets.push_back((void*)offset);
+            group.baseVertices.push_back(mesh.baseVertex);
+        }
+        stats.trianglesDrawn += (int)(cluster.indexCount / 3);
+    }
+    return true;
+}
+
+void GLTFRenderer::toggleClusterCulling() {
+    clusterCullingEnabled = !clusterCullingEnabled;
+    std::cout << "Culling por clusters: " << (clusterCullingEnabled ? "ligado" : "desligado") << std::endl;
+}
+
+void GLTFRenderer::toggleFrustumCulling() {
+    frustumCullingEnabled = !frustumCullingEnabled;
+    std::cout << "Frustum culling: " << (frustumCullingEnabled ? "ligado" : "desligado") << std::endl;
+}
@@ -1,6 +1,11 @@
 #include "GLTFRenderer.h"
+#include "VertexBake.h"
+#include "AccessorDecode.h"
+#include "MeshOptimize.h"
 #include <cstring>
+#include <cstdio>
 #include <cctype>
+#include <chrono>
 #define TINYGLTF_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -10,17 +15,196 @@ bool GLTFRenderer::loadGLTF(const std::string& filepath) {
     return loadGLTF(filepath, glm::mat4(1.0f));
 }
 
-bool GLTFRenderer::loadGLTF(const std::string& filepath, const glm::mat4& baseTransform) {
-    tinygltf::Model gltfModel;
+bool GLTFRenderer::loadGLTF(const std::string& filepath, const glm::mat4& baseTransform, VertexFormat format) {
+    // O asset é lido e enviado à GPU apenas na primeira vez; as próximas chamadas só criam instâncias
+    const ModelAsset* asset = acquireModelAsset(filepath, format);
+    if (!asset || asset->meshIndices.empty()) return false;
+    instantiateAsset(filepath, *asset, baseTransform);
+    return true;
+}
+
+void GLTFRenderer::instantiateAsset(const std::string& filepath, const ModelAsset& asset, const glm::mat4& baseTransform) {
+    // Caixas de colisão, clipes e portas são estado da simulação (que pode estar em outra thread)
+    std::lock_guard<std::mutex> lock(simMutex);
+    // Uma raiz com a transformação base; a hierarquia do asset pendurada nela (pré-ordem: pais antes)
+    int root = addSceneNode(-1, baseTransform, filepath);
+    size_t firstInstance = instances.size();
+    std::vector<int> nodeMap(asset.nodes.size(), root);
+    for (size_t i = 0; i < asset.nodes.size(); ++i) {
+        const AssetNode& node = asset.nodes[i];
+        int parent = node.parent >= 0 ? nodeMap[node.parent] : root;
+        nodeMap[i] = addSceneNode(parent, node.local, node.name);
+    }
+    for (size_t k = 0; k < asset.meshIndices.size(); ++k) {
+        int assetNode = asset.meshNodes[k];
+        addInstanceAtNode(asset.meshIndices[k], assetNode >= 0 ? nodeMap[assetNode] : root);
+    }
+    // Cada instância do asset tem seus próprios clipes (mesmo nome), presos aos nós desta instância
+    if (!asset.animations.empty()) {
+        int first = animations.addClips(asset.animations, nodeMap, scene);
+        for (int clip = first; clip < animations.clipCount(); ++clip) {
+            modelClips.push_back(clip);
+            if (modelAnimationsPlaying) animations.play(clip, 1.0f, true);
+        }
+    }
+    initDoors();
+    addRooms(asset.rooms, asset.portals, baseTransform, firstInstance);
+    if (floorVAO == 0) createFloor();
+    // Criar textura de pedra para o mesh "chao"
+    if (chaoTexture == 0) chaoTexture = createTextureFromFile("chao.png", false);
+    if (chaoMaterialId >= 0) materials[chaoMaterialId].texture = chaoTexture;
+}
+
+const ModelAsset* GLTFRenderer::acquireModelAsset(const std::string& filepath, VertexFormat format) {
+    auto cached = assetCache.find(filepath);
+    if (cached != assetCache.end()) {
+        std::cout << "Asset em cache: '" << filepath << "'" << std::endl;
+        return &cached->second;
+    }
+
+    StagedAsset staged;
+    if (!stageModelAsset(filepath, format, staged)) return nullptr;
+    // Upload só na thread do GL, na ordem do arquivo
+    ModelAsset asset;
+    for (auto& mesh : staged.meshes) commitStagedMesh(mesh, asset);
+    if (asset.meshIndices.empty()) return nullptr;
+    asset.nodes = std::move(staged.nodes);
+    asset.animations = std::move(staged.animations);
+    asset.rooms = std::move(staged.rooms);
+    asset.portals = std::move(staged.portals);
+    reportVertexMemory(filepath, asset);
+    return &(assetCache[filepath] = std::move(asset));
+}
+
+// Quantiza os vértices cozidos na AABB do mesh (arquivo cozido continua em float: o formato é por carga)
+static void packStagedMesh(StagedMesh& staged) {
+    Mesh& mesh = staged.mesh;
+    staged.compactVertices.resize(staged.vertexCount);
+    packCompactVertices(staged.vertices, staged.vertexCount, mesh.localMin, mesh.localMax,
+                        staged.compactVertices.data());
+    mesh.compact = true;
+    mesh.dequantize = compactDequantizeMatrix(mesh.localMin, mesh.localMax);
+    mesh.vertices = std::vector<float>();
+    staged.vertices = nullptr;
+}
+
+bool GLTFRenderer::stageModelAsset(const std::string& filepath, VertexFormat format, StagedAsset& staged) {
+    // Só CPU (chamado também das threads do pool). Caminho rápido: arquivo cozido (.tjmesh) válido, mapeado
+    if (!stageCookedModel(filepath, staged)) {
+        tinygltf::Model gltfModel;
+        GLTFSource source;
+        if (!parseGLTFFile(filepath, gltfModel, source)) return false;
+        std::vector<Mesh> decoded;
+        decodeModel(gltfModel, source, decoded, staged.nodes, staged.animations);
+        if (decoded.empty()) return false;
+        // Cozinhar na primeira carga: as próximas execuções não passam mais pelo tinygltf
+        writeCookedModel(filepath, gltfModel, decoded, staged.nodes, staged.animations);
+
+        staged.meshes.resize(decoded.size());
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            StagedMesh& out = staged.meshes[i];
+            out.mesh = std::move(decoded[i]);
+            out.vertices = out.mesh.vertices.data();
+            out.vertexCount = out.mesh.vertices.size() / 8;
+            out.indexCount = out.mesh.indices.size();
+            if (fitsShortIndices(out.vertexCount)) {
+                // Mesma forma do arquivo cozido: 16 bits sempre que os vértices cabem
+                out.shortIndices.resize(out.indexCount);
+                narrowIndices(out.mesh.indices.data(), out.indexCount, out.shortIndices.data());
+                out.mesh.indices = std::vector<unsigned int>();
+                out.indices = out.shortIndices.data();
+                out.indexSize = 2;
+            } else {
+                out.indices = out.mesh.indices.data();
+            }
+        }
+    }
+    if (format == VertexFormat::Compact) {
+        for (auto& mesh : staged.meshes) packStagedMesh(mesh);
+    }
+    // Salas/portais opcionais ao lado do modelo (ex.: models/TJAL.rooms), lidos junto com o asset
+    size_t dot = filepath.find_last_of('.');
+    parseRooms(filepath.substr(0, dot) + ".rooms", staged.rooms, staged.portals);
+    return true;
+}
+
+bool GLTFRenderer::commitStagedMesh(StagedMesh& staged, ModelAsset& asset) {
+    const void* vertices = staged.mesh.compact ? (const void*)staged.compactVertices.data() : staged.vertices;
+    if (!uploadMeshGeometry(staged.mesh, vertices, staged.vertexCount, staged.indices, staged.indexCount,
+                            staged.indexSize)) {
+        return false;
+    }
+    size_t bytesPerVertex = vertexFormatBytes(arenaFor(staged.mesh).format);
+    asset.vertexBytes += staged.vertexCount * bytesPerVertex;
+    size_t saved = staged.vertexCount * (vertexFormatBytes(VertexFormat::Full) - bytesPerVertex);
+    asset.vertexBytesSaved += saved;
+    vertexBytesSavedTotal += saved;
+    // A cópia na CPU (se houver) não é usada depois do upload
+    staged.mesh.vertices = std::vector<float>();
+    staged.mesh.indices = std::vector<unsigned int>();
+    staged.compactVertices = std::vector<CompactVertex>();
+    staged.shortIndices = std::vector<uint16_t>();
+    staged.vertices = nullptr;
+    staged.indices = nullptr;
+    asset.meshIndices.push_back((int)meshes.size());
+    asset.meshNodes.push_back(staged.mesh.assetNode);
+    meshes.push_back(std::move(staged.mesh));
+    return true;
+}
+
+void GLTFRenderer::reportVertexMemory(const std::string& filepath, const ModelAsset& asset) const {
+    if (asset.vertexBytesSaved == 0) return;
+    size_t fullBytes = asset.vertexBytes + asset.vertexBytesSaved;
+    std::cout << "Vértices compactos em '" << filepath << "': " << asset.vertexBytes / 1024 << " KB em vez de "
+              << fullBytes / 1024 << " KB (" << asset.vertexBytesSaved / 1024 << " KB economizados, -"
+              << (100 * asset.vertexBytesSaved / fullBytes) << "%)" << std::endl;
+}
+
+// Cabeçalho e chunks de um .glb (little-endian): "glTF", versão 2, tamanho; chunks JSON e BIN
+static const uint32_t kGLBMagic = 0x46546C67;
+static const uint32_t kGLBChunkBIN = 0x004E4942;
+
+static bool findGLBBinChunk(const MappedFile& file, BufferSpan& bin) {
+    if (file.size < 20) return false;
+    uint32_t header[3];
+    std::memcpy(header, file.data, sizeof(header));
+    if (header[0] != kGLBMagic || header[1] != 2 || header[2] > file.size) return false;
+    size_t offset = 12;
+    while (offset + 8 <= header[2]) {
+        uint32_t chunk[2]; // tamanho, tipo
+        std::memcpy(chunk, file.data + offset, sizeof(chunk));
+        offset += 8;
+        if (offset + chunk[0] > header[2]) return false;
+        if (chunk[1] == kGLBChunkBIN) {
+            bin.data = file.data + offset;
+            bin.size = chunk[0];
+            return true;
+        }
+        offset += (chunk[0] + 3) & ~3u;
+    }
+    return false;
+}
+
+bool GLTFRenderer::parseGLTFFile(const std::string& filepath, tinygltf::Model& gltfModel, GLTFSource& source) const {
     tinygltf::TinyGLTF loader;
     std::string err, warn;
 
     // Detectar extensão para suportar .gltf (ASCII) e .glb (binário)
     auto toLower = [](std::string s){ for (auto& c : s) c = (char)std::tolower(c); return s; };
     std::string lower = toLower(filepath);
+    bool isGLB = lower.size() >= 4 && lower.substr(lower.size() - 4) == ".glb";
     bool ok = false;
-    if (lower.size() >= 4 && lower.substr(lower.size() - 4) == ".glb") {
-        ok = loader.LoadBinaryFromFile(&gltfModel, &err, &warn, filepath);
+    if (isGLB) {
+        // .glb mapeado: o tinygltf lê o JSON direto do mapeamento (sem ler o arquivo para o heap)
+        source.mapping.reset(new MappedFile());
+        if (!source.mapping->open(filepath)) {
+            std::cerr << "Erro ao mapear GLB: '" << filepath << "'" << std::endl;
+            return false;
+        }
+        size_t slash = filepath.find_last_of('/');
+        std::string baseDir = (slash == std::string::npos) ? "" : filepath.substr(0, slash);
+        ok = loader.LoadBinaryFromMemory(&gltfModel, &err, &warn, source.mapping->data,
+                                         (unsigned int)source.mapping->size, baseDir);
     } else {
         ok = loader.LoadASCIIFromFile(&gltfModel, &err, &warn, filepath);
     }
@@ -29,68 +213,324 @@ bool GLTFRenderer::loadGLTF(const std::string& filepath, const glm::mat4& baseTr
         std::cerr << "Erro ao carregar GLTF: " << err << std::endl;
         return false;
     }
-
     if (gltfModel.buffers.empty()) return false;
-    const auto& buffer = gltfModel.buffers[0].data;
 
-    bool loaded = false;
-    
-    // Carregar meshes com suas transformações dos nós
-    for (const auto& node : gltfModel.nodes) {
-        if (node.mesh >= 0 && node.mesh < gltfModel.meshes.size()) {
-            const auto& mesh = gltfModel.meshes[node.mesh];
-            
-            // Construir matriz de transformação do nó
-            glm::mat4 nodeTransform(1.0f);
-            if (node.matrix.size() == 16) {
-                // Usar matriz diretamente se fornecida
-                nodeTransform = glm::mat4(
-                    node.matrix[0], node.matrix[1], node.matrix[2], node.matrix[3],
-                    node.matrix[4], node.matrix[5], node.matrix[6], node.matrix[7],
-                    node.matrix[8], node.matrix[9], node.matrix[10], node.matrix[11],
-                    node.matrix[12], node.matrix[13], node.matrix[14], node.matrix[15]
-                );
+    source.buffers.resize(gltfModel.buffers.size());
+    for (size_t i = 0; i < gltfModel.buffers.size(); ++i) {
+        auto& buffer = gltfModel.buffers[i];
+        BufferSpan bin;
+        if (isGLB && buffer.uri.empty() && findGLBBinChunk(*source.mapping, bin)) {
+            // Buffer embutido: ler do chunk BIN mapeado e liberar já a cópia feita pelo tinygltf,
+            // antes do decode (o pico fica em uma cópia da geometria: o destino intercalado)
+            source.buffers[i] = bin;
+            std::vector<unsigned char>().swap(buffer.data);
+        } else {
+            source.buffers[i].data = buffer.data.data();
+            source.buffers[i].size = buffer.data.size();
+        }
+    }
+    return true;
+}
+
+// Matriz local de um nó glTF: matriz explícita ou T * R * S
+static glm::mat4 nodeLocalMatrix(const tinygltf::Node& node) {
+    if (node.matrix.size() == 16) {
+        // Usar matriz diretamente se fornecida
+        return glm::mat4(
+            node.matrix[0], node.matrix[1], node.matrix[2], node.matrix[3],
+            node.matrix[4], node.matrix[5], node.matrix[6], node.matrix[7],
+            node.matrix[8], node.matrix[9], node.matrix[10], node.matrix[11],
+            node.matrix[12], node.matrix[13], node.matrix[14], node.matrix[15]
+        );
+    }
+    glm::vec3 translation(0.0f);
+    glm::vec3 scale(1.0f);
+    glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f); // identidade
+
+    if (!node.translation.empty()) {
+        translation = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
+    }
+    if (!node.scale.empty()) {
+        scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
+    }
+    if (!node.rotation.empty()) {
+        // glTF usa [x, y, z, w] mas glm::quat é [w, x, y, z]
+        rotation = glm::quat((float)node.rotation[3], (float)node.rotation[0],
+                           (float)node.rotation[1], (float)node.rotation[2]);
+    }
+
+    // Compor: T * R * S
+    glm::mat4 T = glm::translate(glm::mat4(1.0f), translation);
+    glm::mat4 R = glm::mat4_cast(rotation);
+    glm::mat4 S = glm::scale(glm::mat4(1.0f), scale);
+    return T * R * S;
+}
+
+// Portas reconhecidas pelo nome do nó (giram pela matriz local do nó: não podem ser cozidas no pai)
+static bool isDoorName(const std::string& name) {
+    return name == "porta_front_1" || name == "porta_front_2" || name == "porta_interna_1";
+}
+
+void GLTFRenderer::decodeModel(const tinygltf::Model& gltfModel, const GLTFSource& source, std::vector<Mesh>& out,
+                               std::vector<AssetNode>& nodes, AnimationSet& animations) {
+    // Só CPU: vértices intercalados (pos, normal, uv) e hierarquia de nós em pré-ordem em nodes; animações em
+    // animations. Cada mesh fica preso ao nó móvel (animado ou porta) mais próximo acima dele, ou à raiz do
+    // asset, com as matrizes estáticas do caminho (escala não uniforme inclusive) cozidas nos vértices: o
+    // asset estático inteiro divide uma matriz de mundo (grupos de fusão) e os cones dos clusters ficam no
+    // espaço cozido. Passada serial coleta as primitivas; o decode de cada uma roda em paralelo no pool
+    struct PrimitiveJob {
+        const tinygltf::Primitive* primitive;
+        std::string name;
+        int node;             // nó ao qual o mesh fica preso (-1 = raiz do asset)
+        glm::mat4 transform;  // do espaço do mesh para o espaço desse nó
+    };
+    std::vector<PrimitiveJob> jobs;
+
+    std::vector<char> animated(gltfModel.nodes.size(), 0);
+    for (const auto& animation : gltfModel.animations) {
+        for (const auto& channel : animation.channels) {
+            if (channel.target_node >= 0 && channel.target_node < (int)animated.size()) animated[channel.target_node] = 1;
+        }
+    }
+
+    // Raízes: a cena padrão (ou a primeira); sem cenas, todo nó que não é filho de ninguém
+    std::vector<int> roots;
+    int sceneIndex = gltfModel.defaultScene >= 0 ? gltfModel.defaultScene : 0;
+    if (sceneIndex < (int)gltfModel.scenes.size()) {
+        roots = gltfModel.scenes[sceneIndex].nodes;
+    } else {
+        std::vector<char> isChild(gltfModel.nodes.size(), 0);
+        for (const auto& node : gltfModel.nodes) {
+            for (int child : node.children) {
+                if (child >= 0 && child < (int)isChild.size()) isChild[child] = 1;
+            }
+        }
+        for (size_t i = 0; i < gltfModel.nodes.size(); ++i) {
+            if (!isChild[i]) roots.push_back((int)i);
+        }
+    }
+
+    // Percurso em profundidade com pilha explícita (filhos empilhados ao contrário: ordem do arquivo);
+    // visited protege contra arquivos com ciclos ou nós repetidos
+    std::vector<char> visited(gltfModel.nodes.size(), 0);
+    std::vector<int> assetNodeOf(gltfModel.nodes.size(), -1); // nó glTF -> índice em nodes
+    std::vector<int> anchorOf;                                  // por nó de nodes: nó móvel acima (ou ele mesmo)
+    std::vector<glm::mat4> toAnchor;                            // por nó de nodes: espaço do nó -> espaço da âncora
+    std::vector<std::pair<int, int>> stack; // (nó glTF, nó pai em nodes)
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it) stack.push_back({ *it, -1 });
+    while (!stack.empty()) {
+        std::pair<int, int> entry = stack.back();
+        stack.pop_back();
+        int gltfIndex = entry.first;
+        if (gltfIndex < 0 || gltfIndex >= (int)gltfModel.nodes.size() || visited[gltfIndex]) continue;
+        visited[gltfIndex] = 1;
+        const auto& node = gltfModel.nodes[gltfIndex];
+        AssetNode assetNode;
+        assetNode.name = node.name;
+        assetNode.parent = entry.second;
+        assetNode.local = nodeLocalMatrix(node);
+        int nodeIndex = (int)nodes.size();
+        nodes.push_back(assetNode);
+        assetNodeOf[gltfIndex] = nodeIndex;
+
+        bool hasMesh = node.mesh >= 0 && node.mesh < (int)gltfModel.meshes.size();
+        // Usar o nome do nó em vez do nome do mesh para detecção de interações
+        std::string interactionName = !node.name.empty() || !hasMesh ? node.name : gltfModel.meshes[node.mesh].name;
+        if (animated[gltfIndex] || isDoorName(interactionName)) {
+            anchorOf.push_back(nodeIndex);
+            toAnchor.push_back(glm::mat4(1.0f));
+        } else if (entry.second >= 0) {
+            anchorOf.push_back(anchorOf[entry.second]);
+            toAnchor.push_back(toAnchor[entry.second] * assetNode.local);
+        } else {
+            anchorOf.push_back(-1);
+            toAnchor.push_back(assetNode.local);
+        }
+
+        if (hasMesh) {
+            for (const auto& primitive : gltfModel.meshes[node.mesh].primitives) {
+                jobs.push_back({ &primitive, interactionName, anchorOf[nodeIndex], toAnchor[nodeIndex] });
+            }
+        }
+        for (auto child = node.children.rbegin(); child != node.children.rend(); ++child) {
+            stack.push_back({ *child, nodeIndex });
+        }
+    }
+
+    decodeAnimations(gltfModel, source, assetNodeOf, animations);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<Mesh> decoded(jobs.size());
+    std::vector<char> valid(jobs.size(), 0);
+    std::vector<MeshOptimizeStats> optimized(jobs.size());
+    JobSystem& pool = jobSystem();
+    pool.parallelFor(jobs.size(), [&](size_t i) {
+        // Cada tarefa escreve só no próprio slot: nenhuma sincronização além do fim do parallelFor
+        const PrimitiveJob& job = jobs[i];
+        valid[i] = decodePrimitive(*job.primitive, gltfModel, source.buffers, job.name, job.transform, decoded[i]);
+        decoded[i].assetNode = job.node;
+        // Solda + ordem para o cache de vértices + LODs; o resultado é o que vai para o arquivo cozido.
+        // Lista recusada pela otimização fica como veio, só com o nível completo e sem clusters
+        if (valid[i]) {
+            Mesh& mesh = decoded[i];
+            mesh.lods[0].indexCount = (uint32_t)mesh.indices.size();
+            if (!optimizeMesh(mesh.vertices, mesh.indices, optimized[i])) return;
+            mesh.lodCount = buildMeshLods(mesh.vertices, mesh.indices, mesh.lods);
+            buildMeshClusters(mesh.vertices, mesh.indices, mesh.lods[0].indexCount, mesh.clusters);
+        }
+    });
+    double decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Ordem do arquivo preservada (índices de mesh estáveis entre execuções e no arquivo cozido)
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (!valid[i]) continue;
+        const MeshOptimizeStats& opt = optimized[i];
+        char acmr[64];
+        std::snprintf(acmr, sizeof(acmr), "%.3f -> %.3f", opt.acmrBefore, opt.acmrAfter);
+        const Mesh& mesh = decoded[i];
+        std::cout << "Mesh carregado: '" << mesh.name << "' (" << opt.verticesBefore << " -> "
+                  << opt.verticesAfter << " vértices, ACMR " << acmr << ", LODs";
+        for (int l = 0; l < mesh.lodCount; ++l) std::cout << " " << mesh.lods[l].indexCount / 3;
+        std::cout << " triângulos";
+        if (!mesh.clusters.empty()) std::cout << ", " << mesh.clusters.size() << " clusters";
+        std::cout << ")" << std::endl;
+        out.push_back(std::move(decoded[i]));
+    }
+    std::cout << "Decode: " << jobs.size() << " primitivas em " << decodeMs << " ms ("
+              << pool.threadCount() + 1 << " threads, kernel " << vertexBakeKernelName(bestVertexBakeKernel()) << ")" << std::endl;
+}
+
+void GLTFRenderer::decodeAnimations(const tinygltf::Model& gltfModel, const GLTFSource& source,
+                                    const std::vector<int>& assetNodeOf, AnimationSet& animations) const {
+    // Canais de nós fora da cena importada, de pesos de morph targets ou com accessors inválidos são ignorados
+    for (size_t a = 0; a < gltfModel.animations.size(); ++a) {
+        const auto& animation = gltfModel.animations[a];
+        AnimationClip clip;
+        clip.name = !animation.name.empty() ? animation.name : "animacao_" + std::to_string(a);
+        clip.firstChannel = (uint32_t)animations.channels.size();
+        for (const auto& channel : animation.channels) {
+            if (channel.sampler < 0 || channel.sampler >= (int)animation.samplers.size()) continue;
+            if (channel.target_node < 0 || channel.target_node >= (int)assetNodeOf.size() ||
+                assetNodeOf[channel.target_node] < 0) continue;
+            AnimationChannel out;
+            out.node = assetNodeOf[channel.target_node];
+            int components = 3;
+            if (channel.target_path == "translation") {
+                out.path = (uint8_t)AnimationPath::Translation;
+            } else if (channel.target_path == "rotation") {
+                out.path = (uint8_t)AnimationPath::Rotation;
+                components = 4;
+            } else if (channel.target_path == "scale") {
+                out.path = (uint8_t)AnimationPath::Scale;
             } else {
-                // Compor TRS (Translation, Rotation, Scale)
-                glm::vec3 translation(0.0f);
-                glm::vec3 scale(1.0f);
-                glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f); // identidade
-                
-                if (!node.translation.empty()) {
-                    translation = glm::vec3(node.translation[0], node.translation[1], node.translation[2]);
-                }
-                if (!node.scale.empty()) {
-                    scale = glm::vec3(node.scale[0], node.scale[1], node.scale[2]);
-                }
-                if (!node.rotation.empty()) {
-                    // glTF usa [x, y, z, w] mas glm::quat é [w, x, y, z]
-                    rotation = glm::quat((float)node.rotation[3], (float)node.rotation[0], 
-                                       (float)node.rotation[1], (float)node.rotation[2]);
-                }
-                
-                // Compor: T * R * S
-                glm::mat4 T = glm::translate(glm::mat4(1.0f), translation);
-                glm::mat4 R = glm::mat4_cast(rotation);
-                glm::mat4 S = glm::scale(glm::mat4(1.0f), scale);
-                nodeTransform = T * R * S;
+                continue;
             }
-            
-            for (const auto& primitive : mesh.primitives) {
-                // Usar o nome do nó em vez do nome do mesh para detecção de interações
-                std::string interactionName = !node.name.empty() ? node.name : mesh.name;
-                if (loadPrimitive(primitive, gltfModel, buffer, interactionName, baseTransform * nodeTransform)) {
-                    loaded = true;
-                }
+            const auto& sampler = animation.samplers[channel.sampler];
+            AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+            if (sampler.interpolation == "STEP") interpolation = AnimationInterpolation::Step;
+            else if (sampler.interpolation == "CUBICSPLINE") interpolation = AnimationInterpolation::CubicSpline;
+            out.interpolation = (uint8_t)interpolation;
+            if (sampler.input < 0 || sampler.input >= (int)gltfModel.accessors.size() ||
+                sampler.output < 0 || sampler.output >= (int)gltfModel.accessors.size()) continue;
+            const auto& input = gltfModel.accessors[sampler.input];
+            const auto& output = gltfModel.accessors[sampler.output];
+            size_t keyCount = input.count;
+            size_t valuesPerKey = interpolation == AnimationInterpolation::CubicSpline ? 3 : 1;
+            if (keyCount == 0 || output.count < keyCount * valuesPerKey) {
+                std::cerr << "Canal de animação sem chaves suficientes em '" << clip.name << "'" << std::endl;
+                continue;
             }
+
+            out.firstKey = (uint32_t)animations.times.size();
+            out.keyCount = (uint32_t)keyCount;
+            out.firstValue = (uint32_t)animations.values.size();
+            animations.times.resize(out.firstKey + keyCount);
+            animations.values.resize(out.firstValue + keyCount * valuesPerKey * components);
+            float* keyTimes = animations.times.data() + out.firstKey;
+            bool ok = decodeAccessor(input, gltfModel, source.buffers, keyTimes, 1, 1, keyCount) &&
+                      decodeAccessor(output, gltfModel, source.buffers, animations.values.data() + out.firstValue,
+                                     components, components, keyCount * valuesPerKey);
+            // A busca de chave depende de tempos crescentes
+            if (ok && !std::is_sorted(keyTimes, keyTimes + keyCount)) {
+                std::cerr << "Tempos de animação fora de ordem em '" << clip.name << "'" << std::endl;
+                ok = false;
+            }
+            if (!ok) {
+                animations.times.resize(out.firstKey);
+                animations.values.resize(out.firstValue);
+                continue;
+            }
+            clip.duration = std::max(clip.duration, keyTimes[keyCount - 1]);
+            animations.channels.push_back(out);
         }
+        clip.channelCount = (uint32_t)animations.channels.size() - clip.firstChannel;
+        if (clip.channelCount == 0) continue;
+        std::cout << "Animação: '" << clip.name << "' (" << clip.channelCount << " canais, "
+                  << clip.duration << " s)" << std::endl;
+        animations.clips.push_back(clip);
     }
-    if (loaded) {
-        initDoors();
-        createFloor();
-        // Criar textura de pedra para o mesh "chao"
-        chaoTexture = createTextureFromFile("chao.png", false);
+}
+
+JobSystem& GLTFRenderer::jobSystem() {
+    // Criado no primeiro uso (carga ou primeiro frame), sempre na thread do GL
+    if (!workers) workers.reset(new JobSystem());
+    return *workers;
+}
+
+int GLTFRenderer::addSceneNode(int parent, const glm::mat4& local, const std::string& name) {
+    int node = scene.addNode(parent, local);
+    if (node < 0) {
+        // Só acontece fora da ordem de construção (pai com a subárvore já fechada): vira uma raiz
+        std::cerr << "Nó '" << name << "' fora da pré-ordem; adicionado como raiz" << std::endl;
+        node = scene.addNode(-1, parent >= 0 ? scene.world(parent) * local : local);
     }
-    return loaded;
+    nodeInstances.push_back(-1);
+    return node;
+}
+
+void GLTFRenderer::addInstance(int meshIndex, const glm::mat4& transform) {
+    // Instância avulsa: um nó raiz só dela
+    addInstanceAtNode(meshIndex, addSceneNode(-1, transform, meshes[meshIndex].name));
+}
+
+void GLTFRenderer::addInstanceAtNode(int meshIndex, int node) {
+    const Mesh& mesh = meshes[meshIndex];
+    MeshInstance inst;
+    inst.meshIndex = meshIndex;
+    inst.node = node;
+    inst.nextInNode = nodeInstances[node];
+    inst.materialId = materialForMesh(mesh.name);
+    nodeInstances[node] = (int)instances.size();
+    instances.push_back(inst);
+    instanceBatchesDirty = true;
+    if (mesh.name == "chao") {
+        chaoInstanceIndex = (int)instances.size() - 1;
+    }
+    worldTransforms.emplace_back(1.0f);
+    normalTransforms.emplace_back(1.0f);
+    setInstanceTransform((int)instances.size() - 1, instanceWorldMatrix((int)instances.size() - 1));
+
+    // Bounding box de mundo (culling) e para física/colisão
+    AABB world = transformAABB(worldTransforms.back(), mesh.localMin, mesh.localMax);
+    instanceBounds.push_back(world);
+    bvhDirty = true;
+
+    BoundingBox bbox;
+    bbox.meshName = mesh.name;
+    bbox.min = world.min;
+    bbox.max = world.max;
+
+    // Expandir um pouco a bounding box para evitar colisões muito próximas
+    // Para a escada e portas, NÃO expandimos para preservar pivô/altura/comprimento reais
+    bool noPad = (bbox.meshName == "escada") ||
+                 (bbox.meshName == "porta_front_1") ||
+                 (bbox.meshName == "porta_front_2");
+    float padding = noPad ? 0.0f : 0.1f;
+    bbox.min -= glm::vec3(padding);
+    bbox.max += glm::vec3(padding);
+
+    // Adicionar às colisões
+    collisionBoxes.push_back(bbox);
 }
 
 bool GLTFRenderer::loadGLTFAt(const std::string& filepath, const glm::vec3& worldPos) {
@@ -162,262 +602,159 @@ bool GLTFRenderer::loadGLTFAtOnChao(const std::string& filepath, const glm::vec2
     return loadGLTF(filepath, T);
 }
 
-bool GLTFRenderer::loadPrimitive(const tinygltf::Primitive& primitive,
+// Portas reconhecidas pelo nome do nó; o resultado vai para o arquivo cozido junto com o mesh
+static void classifyDoorMesh(Mesh& mesh) {
+    mesh.isDoor = isDoorName(mesh.name);
+    mesh.doorHingeLeft = (mesh.name == "porta_front_1" || mesh.name == "porta_interna_1");
+}
+
+bool GLTFRenderer::decodePrimitive(const tinygltf::Primitive& primitive,
                    const tinygltf::Model& model,
-                   const std::vector<unsigned char>& binaryData,
+                   const std::vector<BufferSpan>& buffers,
                    const std::string& meshName,
-                   const glm::mat4& nodeTransform) {
+                   const glm::mat4& transform,
+                   Mesh& mesh) const {
 
     if (primitive.indices == -1) return false;
     auto posIt = primitive.attributes.find("POSITION");
     if (posIt == primitive.attributes.end()) return false;
+    const auto& posAccessor = model.accessors[posIt->second];
+    size_t vertexCount = posAccessor.count;
+    if (vertexCount == 0) return false;
+
+    // Atributos decodificados direto no destino intercalado (pos, normal, uv), sem vetores intermediários.
+    // Padrões (normal para cima, uv zero) ficam onde o atributo não existe ou não pôde ser lido
+    mesh.vertices.resize(vertexCount * 8);
+    float* v = mesh.vertices.data();
+    for (size_t i = 0; i < vertexCount; ++i, v += 8) {
+        v[3] = 0.0f; v[4] = 1.0f; v[5] = 0.0f;
+        v[6] = 0.0f; v[7] = 0.0f;
+    }
+    if (!decodeAccessor(posAccessor, model, buffers, mesh.vertices.data(), 8, 3, vertexCount)) return false;
 
-    Mesh mesh;
-    std::vector<float> positions;
-    if (!loadAccessorData(model.accessors[posIt->second], model, binaryData, positions)) return false;
-
-    std::vector<float> normals;
     auto normalIt = primitive.attributes.find("NORMAL");
     if (normalIt != primitive.attributes.end()) {
-        loadAccessorData(model.accessors[normalIt->second], model, binaryData, normals);
+        decodeAccessor(model.accessors[normalIt->second], model, buffers, mesh.vertices.data() + 3, 8, 3, vertexCount);
     }
 
-    std::vector<float> texCoords;
     auto texIt = primitive.attributes.find("TEXCOORD_0");
     if (texIt != primitive.attributes.end()) {
         // Passar isTexCoord=true para suportar UBYTE/USHORT normalizados
-        loadAccessorData(model.accessors[texIt->second], model, binaryData, texCoords, /*isTexCoord=*/true);
-    }
-
-    size_t vertexCount = positions.size() / 3;
-    glm::vec3 minPos(FLT_MAX), maxPos(-FLT_MAX);
-    for (size_t i = 0; i < vertexCount; ++i) {
-        glm::vec3 pos(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
-        minPos = glm::min(minPos, pos);
-        maxPos = glm::max(maxPos, pos);
-    }
-
-    glm::vec3 center = (minPos + maxPos) * 0.5f;
-    glm::vec3 size = maxPos - minPos;
-
-    float maxDimension = glm::max(glm::max(size.x, size.y), size.z);
-    float scale = 5.0f / maxDimension;
-    float scaleX = 1.0f;
-    float scaleY = 1.5f;
-    float scaleZ = 0.1f;
-
-    // Usar transformações originais do GLTF para todos os meshes
-    bool useOriginalTransform = true;
-    
-    if (useOriginalTransform) {
-        scaleX = 1.0f;
-        scaleY = 1.0f;
-        scaleZ = 1.0f;
-        scale = 1.0f; // Usar tamanho real sem escala adicional
+        decodeAccessor(model.accessors[texIt->second], model, buffers, mesh.vertices.data() + 6, 8, 2, vertexCount,
+                       /*isTexCoord=*/true);
     }
 
-    // Salvar as dimensões calculadas para uso posterior
-    modelSize = glm::vec3(size.x * scale * scaleX, size.y * scale * scaleY, size.z * scale * scaleZ);
-    modelCenter = center;
-
-    floorMin = glm::vec3(-3.0f, -0.1f, -3.0f);
-    floorMax = glm::vec3( 3.0f, -0.1f,  3.0f);
-
-    mesh.vertices.reserve(vertexCount * 8);
-
-    float minYNormalized = FLT_MAX;
-    std::vector<glm::vec3> normalizedPositions;
-    normalizedPositions.reserve(vertexCount);
-
-    for (size_t i = 0; i < vertexCount; ++i) {
-        glm::vec3 originalPos(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
-        
-        glm::vec3 normalizedPos;
-        if (useOriginalTransform) {
-            glm::vec4 transformedPos = nodeTransform * glm::vec4(originalPos, 1.0f);
-            normalizedPos = glm::vec3(transformedPos); // Sem escala adicional
-        } else {
-            // Modo legado (não usado mais)
-            normalizedPos = (originalPos - center);
-            normalizedPos.x *= scale * scaleX;
-            normalizedPos.y *= scale * scaleY;
-            normalizedPos.z *= scale * scaleZ;
-        }
-        
-        normalizedPositions.push_back(normalizedPos);
-        
-        if (normalizedPos.y < minYNormalized) {
-            minYNormalized = normalizedPos.y;
+    // Matrizes estáticas até o nó ao qual o mesh fica preso (posições e normais) e AABB em uma passada SIMD,
+    // no lugar (VertexBake.cpp); mesh preso ao próprio nó (identidade) só renormaliza as normais
+    bakeVertices(mesh.vertices.data(), vertexCount, transform, mesh.localMin, mesh.localMax);
+
+    if (!loadAccessorIndices(model.accessors[primitive.indices], model, buffers, mesh.indices)) return false;
+    // Índices validados uma única vez aqui: solda, LODs, clusters e a GPU confiam neles sem verificar de novo
+    for (unsigned int index : mesh.indices) {
+        if (index >= vertexCount) {
+            std::cerr << "Primitiva de '" << meshName << "' ignorada: índice " << index << " fora dos "
+                      << vertexCount << " vértices" << std::endl;
+            return false;
         }
     }
-
-    for (size_t i = 0; i < vertexCount; ++i) {
-        glm::vec3 finalPos = normalizedPositions[i];
-        // Manter posição Y original sem ajuste
-        // finalPos.y -= minYNormalized;
-        
-        mesh.vertices.push_back(finalPos.x);
-        mesh.vertices.push_back(finalPos.y);
-        mesh.vertices.push_back(finalPos.z);
-        
-        if (!normals.empty()) {
-            mesh.vertices.push_back(normals[i * 3 + 0]);
-            mesh.vertices.push_back(normals[i * 3 + 1]);
-            mesh.vertices.push_back(normals[i * 3 + 2]);
-        } else {
-            mesh.vertices.push_back(0.0f); mesh.vertices.push_back(1.0f); mesh.vertices.push_back(0.0f);
-        }
-        
-        if (!texCoords.empty()) {
-            mesh.vertices.push_back(texCoords[i * 2 + 0]);
-            mesh.vertices.push_back(texCoords[i * 2 + 1]);
-        } else {
-            mesh.vertices.push_back(0.0f); mesh.vertices.push_back(0.0f);
-        }
+    // Nó espelhado cozido nos vértices: o sentido dos triângulos é invertido para a face frontal continuar
+    // anti-horária (e as normais de face dos clusters apontarem para fora)
+    if (glm::determinant(glm::mat3(transform)) < 0.0f) {
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) std::swap(mesh.indices[i + 1], mesh.indices[i + 2]);
+    }
+    if (primitive.material >= 0 && primitive.material < (int)model.materials.size()) {
+        mesh.doubleSided = model.materials[primitive.material].doubleSided;
     }
-
-    if (!loadAccessorIndices(model.accessors[primitive.indices], model, binaryData, mesh.indices)) return false;
 
     mesh.name = meshName;
-    if (setupMeshBuffers(mesh)) {
-        meshes.push_back(mesh);
-        std::cout << "Mesh carregado: '" << meshName << "'" << std::endl; // Debug
-        if (meshName == "chao") {
-            chaoMeshIndex = (int)meshes.size() - 1;
-        }
-        
-        // Calcular bounding box para física/colisão
-        BoundingBox bbox;
-        bbox.meshName = meshName;
-        bbox.min = glm::vec3(FLT_MAX);
-        bbox.max = glm::vec3(-FLT_MAX);
-        
-        // Calcular limites da bounding box baseado nas posições finais
-        for (size_t i = 0; i < normalizedPositions.size(); ++i) {
-            glm::vec3 finalPos = normalizedPositions[i];
-            // Manter posição Y original para bounding box
-            // finalPos.y -= minYNormalized;
-            
-            bbox.min = glm::min(bbox.min, finalPos);
-            bbox.max = glm::max(bbox.max, finalPos);
-        }
-        
-        // Expandir um pouco a bounding box para evitar colisões muito próximas
-        // Para a escada e portas, NÃO expandimos para preservar pivô/altura/comprimento reais
-        bool noPad = (bbox.meshName == "escada") ||
-                     (bbox.meshName == "porta_front_1") ||
-                     (bbox.meshName == "porta_front_2");
-        float padding = noPad ? 0.0f : 0.1f;
-        bbox.min -= glm::vec3(padding);
-        bbox.max += glm::vec3(padding);
-        
-    // Adicionar às colisões
-        collisionBoxes.push_back(bbox);
-    // (sem culling)
-        
-        return true;
-    }
-    return false;
+    classifyDoorMesh(mesh);
+    return true;
 }
 
-bool GLTFRenderer::loadAccessorData(const tinygltf::Accessor& accessor,
-                      const tinygltf::Model& model,
-                      const std::vector<unsigned char>& /*binaryData*/,
-                      std::vector<float>& out,
-                      bool isTexCoord) {
+// Faixa de bytes de um accessor dentro do seu buffer, com verificação de limites
+static const unsigned char* accessorBytes(const tinygltf::Accessor& accessor, const tinygltf::Model& model,
+                                          const std::vector<BufferSpan>& buffers, size_t elementBytes,
+                                          size_t& stride) {
     // Verificações de segurança - alguns accessors podem ter bufferView = -1 (não utilizados)
     if (accessor.bufferView == -1) {
         // Accessor sem bufferView - normalmente não usado, retornar falso silenciosamente
-        return false;
+        return nullptr;
     }
     
     if (accessor.bufferView < 0 || accessor.bufferView >= model.bufferViews.size()) {
         std::cerr << "bufferView inválido: " << accessor.bufferView << std::endl;
-        return false;
+        return nullptr;
     }
     
     const auto& bufferView = model.bufferViews[accessor.bufferView];
     
-    if (bufferView.buffer < 0 || bufferView.buffer >= model.buffers.size()) {
+    if (bufferView.buffer < 0 || bufferView.buffer >= buffers.size()) {
         std::cerr << "buffer inválido: " << bufferView.buffer << std::endl;
-        return false;
+        return nullptr;
     }
     
-    const auto& buffer = model.buffers[bufferView.buffer];
-    const unsigned char* base = buffer.data.data();
+    const BufferSpan& buffer = buffers[bufferView.buffer];
     size_t offset = bufferView.byteOffset + accessor.byteOffset;
-    int componentCount = tinygltf::GetNumComponentsInType(accessor.type);
-    size_t compSize = tinygltf::GetComponentSizeInBytes(accessor.componentType);
-    size_t stride = bufferView.byteStride ? bufferView.byteStride : (componentCount * compSize);
+    stride = bufferView.byteStride ? bufferView.byteStride : elementBytes;
     
     // Verificar se não vai acessar fora do buffer
-    size_t totalBytesNeeded = offset + (accessor.count - 1) * stride + componentCount * compSize;
-    if (totalBytesNeeded > buffer.data.size()) {
+    size_t totalBytesNeeded = offset + (accessor.count - 1) * stride + elementBytes;
+    if (accessor.count == 0 || totalBytesNeeded > buffer.size) {
         std::cerr << "Tentativa de leitura fora do buffer. Necessário: " << totalBytesNeeded 
-                  << ", disponível: " << buffer.data.size() << std::endl;
-        return false;
-    }
-    
-    out.resize(accessor.count * componentCount);
-
-    // FLOAT path (positions/normals/texcoords típicos)
-    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
-        for (size_t i = 0; i < accessor.count; ++i) {
-            const float* src = reinterpret_cast<const float*>(base + offset + i * stride);
-            for (int c = 0; c < componentCount; ++c) {
-                out[i * componentCount + c] = src[c];
-            }
-        }
-        return true;
-    }
-
-    // TEXCOORD normalizado (UNSIGNED_BYTE/UNSIGNED_SHORT)
-    if (isTexCoord && (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ||
-                       accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)) {
-        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-            for (size_t i = 0; i < accessor.count; ++i) {
-                const unsigned char* src = reinterpret_cast<const unsigned char*>(base + offset + i * stride);
-                for (int c = 0; c < componentCount; ++c) {
-                    out[i * componentCount + c] = static_cast<float>(src[c]) / 255.0f;
-                }
-            }
-        } else { // UNSIGNED_SHORT
-            for (size_t i = 0; i < accessor.count; ++i) {
-                const unsigned short* src = reinterpret_cast<const unsigned short*>(base + offset + i * stride);
-                for (int c = 0; c < componentCount; ++c) {
-                    out[i * componentCount + c] = static_cast<float>(src[c]) / 65535.0f;
-                }
-            }
-        }
-        return true;
+                  << ", disponível: " << buffer.size << std::endl;
+        return nullptr;
     }
+    return buffer.data + offset;
+}
 
-    std::cerr << "Accessor componentType não suportado para este atributo (esperado FLOAT, ou UV normalizado)." << std::endl;
-    return false;
+// Decoder especializado para o tipo do componente; nullptr se o tipo não é de atributo de vértice
+static AccessorDecodeFn selectAccessorDecoder(int componentType, int components, bool normalized, bool packed) {
+    switch (componentType) {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:          return accessorDecoderFor<float>(components, false, packed);
+        case TINYGLTF_COMPONENT_TYPE_BYTE:           return accessorDecoderFor<int8_t>(components, normalized, packed);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:  return accessorDecoderFor<uint8_t>(components, normalized, packed);
+        case TINYGLTF_COMPONENT_TYPE_SHORT:          return accessorDecoderFor<int16_t>(components, normalized, packed);
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: return accessorDecoderFor<uint16_t>(components, normalized, packed);
+        default: return nullptr;
+    }
 }
 
-bool GLTFRenderer::loadAccessorIndices(const tinygltf::Accessor& accessor, const tinygltf::Model& model, const std::vector<unsigned char>& /*binaryData*/, std::vector<unsigned int>& indices) {
-    // Verificações de segurança - alguns accessors podem ter bufferView = -1 (não utilizados)
-    if (accessor.bufferView == -1) {
-        // Accessor sem bufferView - normalmente não usado, retornar falso silenciosamente
+bool GLTFRenderer::decodeAccessor(const tinygltf::Accessor& accessor,
+                      const tinygltf::Model& model,
+                      const std::vector<BufferSpan>& buffers,
+                      float* dst, size_t dstStride, int components, size_t count,
+                      bool isTexCoord) const {
+    // Escreve `components` floats por elemento em dst[i * dstStride]; nada é escrito se falhar
+    int componentCount = tinygltf::GetNumComponentsInType(accessor.type);
+    int compSizeBytes = tinygltf::GetComponentSizeInBytes(accessor.componentType);
+    if (compSizeBytes <= 0) {
+        std::cerr << "Accessor componentType não suportado: " << accessor.componentType << std::endl;
         return false;
     }
-    
-    if (accessor.bufferView < 0 || accessor.bufferView >= model.bufferViews.size()) {
-        std::cerr << "bufferView inválido para índices: " << accessor.bufferView << std::endl;
+    size_t compSize = (size_t)compSizeBytes;
+    if (componentCount < components || accessor.count < count) {
+        std::cerr << "Accessor com componentes/elementos insuficientes para este atributo." << std::endl;
         return false;
     }
-    
-    const auto& bufferView = model.bufferViews[accessor.bufferView];
-    
-    if (bufferView.buffer < 0 || bufferView.buffer >= model.buffers.size()) {
-        std::cerr << "buffer inválido para índices: " << bufferView.buffer << std::endl;
+    size_t stride = 0;
+    const unsigned char* base = accessorBytes(accessor, model, buffers, componentCount * compSize, stride);
+    if (!base) return false;
+
+    // UVs UBYTE/USHORT continuam aceitos como normalizados mesmo sem a flag (arquivos exportados antes)
+    bool normalized = accessor.normalized ||
+                      (isTexCoord && (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE ||
+                                      accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT));
+    bool packed = stride == components * compSize;
+    AccessorDecodeFn decode = selectAccessorDecoder(accessor.componentType, components, normalized, packed);
+    if (!decode) {
+        std::cerr << "Accessor componentType não suportado para este atributo: " << accessor.componentType << std::endl;
         return false;
     }
-    
-    const auto& buffer = model.buffers[bufferView.buffer];
-    size_t offset = bufferView.byteOffset + accessor.byteOffset;
-    
+    decode(base, stride, dst, dstStride, count);
+    return true;
+}
+
+bool GLTFRenderer::loadAccessorIndices(const tinygltf::Accessor& accessor, const tinygltf::Model& model, const std::vector<BufferSpan>& buffers, std::vector<unsigned int>& indices) const {
     // Verificar tamanho do componente
     size_t compSize = 0;
     if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) compSize = 4;
@@ -427,49 +764,112 @@ bool GLTFRenderer::loadAccessorIndices(const tinygltf::Accessor& accessor, const
         std::cerr << "Tipo de índice não suportado: " << accessor.componentType << std::endl;
         return false;
     }
+    size_t stride = 0;
+    const unsigned char* base = accessorBytes(accessor, model, buffers, compSize, stride);
+    if (!base) return false;
     
-    // Verificar se não vai acessar fora do buffer
-    size_t totalBytesNeeded = offset + accessor.count * compSize;
-    if (totalBytesNeeded > buffer.data.size()) {
-        std::cerr << "Tentativa de leitura de índices fora do buffer. Necessário: " << totalBytesNeeded 
-                  << ", disponível: " << buffer.data.size() << std::endl;
-        return false;
-    }
-    
+    // Índices são sempre compactos (bufferView de índices não tem byteStride)
     indices.resize(accessor.count);
-    if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-        std::memcpy(indices.data(), buffer.data.data() + offset, accessor.count * sizeof(unsigned int));
-    } else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-        std::vector<unsigned short> short_indices(accessor.count);
-        std::memcpy(short_indices.data(), buffer.data.data() + offset, accessor.count * sizeof(unsigned short));
-        for(size_t i = 0; i < accessor.count; ++i) indices[i] = short_indices[i];
-    } else if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-        std::vector<unsigned char> byte_indices(accessor.count);
-        std::memcpy(byte_indices.data(), buffer.data.data() + offset, accessor.count * sizeof(unsigned char));
-        for (size_t i = 0; i < accessor.count; ++i) indices[i] = byte_indices[i];
-    }
+    if (compSize == 4) widenIndices<uint32_t>(base, accessor.count, indices.data());
+    else if (compSize == 2) widenIndices<uint16_t>(base, accessor.count, indices.data());
+    else widenIndices<uint8_t>(base, accessor.count, indices.data());
     return true;
 }
 
-bool GLTFRenderer::setupMeshBuffers(Mesh& mesh) {
-    if (mesh.vertices.empty() || mesh.indices.empty()) return false;
-    glGenVertexArrays(1, &mesh.VAO);
-    glGenBuffers(1, &mesh.VBO);
-    glGenBuffers(1, &mesh.EBO);
-    glBindVertexArray(mesh.VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
-    int stride = 8 * sizeof(float);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+void GLTFRenderer::ensureArenaCapacity(GeometryArena& target, size_t extraVertices, size_t extraIndexBytes) {
+    const size_t vertexBytes = vertexFormatBytes(target.format);
+    size_t neededVertices = target.vertexCount + extraVertices;
+    size_t neededIndexBytes = target.indexBytes + extraIndexBytes;
+    if (target.VAO != 0 && neededVertices <= target.vertexCapacity && neededIndexBytes <= target.indexByteCapacity) return;
+
+    // Nova capacidade: dobra até caber (mínimo de 64k vértices / 768 KB de índices)
+    size_t newVertexCapacity = std::max<size_t>(target.vertexCapacity, 65536);
+    while (newVertexCapacity < neededVertices) newVertexCapacity *= 2;
+    size_t newIndexCapacity = std::max<size_t>(target.indexByteCapacity, 3 * 65536 * sizeof(unsigned int));
+    while (newIndexCapacity < neededIndexBytes) newIndexCapacity *= 2;
+
+    if (target.VAO == 0) glGenVertexArrays(1, &target.VAO);
+    glBindVertexArray(target.VAO);
+
+    GLuint newVBO = 0, newEBO = 0;
+    glGenBuffers(1, &newVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, newVBO);
+    glBufferData(GL_ARRAY_BUFFER, newVertexCapacity * vertexBytes, nullptr, GL_STATIC_DRAW);
+    glGenBuffers(1, &newEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, newEBO); // associa o novo EBO ao VAO da arena
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, newIndexCapacity, nullptr, GL_STATIC_DRAW);
+
+    // Copiar o conteúdo antigo direto na GPU, sem passar pela CPU
+    if (target.VBO != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, target.VBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, target.vertexCount * vertexBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, target.EBO);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newEBO);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, target.indexBytes);
+        glDeleteBuffers(1, &target.VBO);
+        glDeleteBuffers(1, &target.EBO);
+    }
+    target.VBO = newVBO;
+    target.EBO = newEBO;
+    target.vertexCapacity = newVertexCapacity;
+    target.indexByteCapacity = newIndexCapacity;
+
+    glBindBuffer(GL_ARRAY_BUFFER, target.VBO);
+    int stride = (int)vertexBytes;
+    if (target.format == VertexFormat::Compact) {
+        // Mesmas localizações do shader: a conversão (unorm, snorm 2_10_10_10, half) é feita pelo hardware
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offsetof(CompactVertex, position));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(CompactVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(CompactVertex, uv));
+    } else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    }
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
-    mesh.indexCount = mesh.indices.size();
-    mesh.isValid = true;
     glBindVertexArray(0);
+}
+
+bool GLTFRenderer::setupMeshBuffers(Mesh& mesh) {
+    if (mesh.vertices.empty() || mesh.indices.empty()) return false;
+    return uploadMeshGeometry(mesh, mesh.vertices.data(), mesh.vertices.size() / 8,
+                              mesh.indices.data(), mesh.indices.size(), sizeof(unsigned int));
+}
+
+bool GLTFRenderer::uploadMeshGeometry(Mesh& mesh, const void* vertices, size_t vertexCount,
+                                      const void* indices, size_t indexCount, unsigned indexSize) {
+    // Fonte pode ser o vetor do mesh ou o arquivo cozido mapeado (nenhuma cópia intermediária)
+    if (vertexCount == 0 || indexCount == 0) return false;
+    GeometryArena& target = arenaFor(mesh);
+    const size_t vertexBytes = vertexFormatBytes(target.format);
+    // Faixa de índices alinhada a 4: depois de uma faixa de 16 bits ímpar, a próxima pode ser de 32
+    size_t indexStart = (target.indexBytes + 3) & ~(size_t)3;
+    size_t indexBytes = indexCount * indexSize;
+    ensureArenaCapacity(target, vertexCount, indexStart - target.indexBytes + indexBytes);
+
+    // Anexar ao fim da arena; índices continuam locais ao mesh (baseVertex no draw)
+    mesh.baseVertex = (GLint)target.vertexCount;
+    mesh.indexOffset = indexStart;
+    mesh.indexType = indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    glBindVertexArray(target.VAO); // EBO é estado do VAO da arena
+    glBindBuffer(GL_ARRAY_BUFFER, target.VBO);
+    glBufferSubData(GL_ARRAY_BUFFER, target.vertexCount * vertexBytes, vertexCount * vertexBytes, vertices);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, target.EBO);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexStart, indexBytes, indices);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    target.vertexCount += vertexCount;
+    target.indexBytes = indexStart + indexBytes;
+
+    mesh.indexCount = indexCount;
+    if (mesh.lods[0].indexCount == 0) {
+        // Sem níveis gerados (caixa de oclusão, malhas pequenas): só o nível completo
+        mesh.lodCount = 1;
+        mesh.lods[0].indexCount = (uint32_t)indexCount;
+    }
+    mesh.isValid = true;
     return true;
 }
@@ -1,64 +1,102 @@
 #include "GLTFRenderer.h"
 #include "../tjal-modelC/lib/tinygltf/tiny_gltf.h"
+#include <chrono>
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Fontes sem a linha #version: compileShader insere "#version" + os #define da variante antes delas
+static const char* kShaderVersion = "#version 330 core\n";
 
 static const char* kVertexShaderSource = R"(
-    #version 330 core
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec3 aNormal;
     layout (location = 2) in vec2 aTexCoord;
     
     out vec3 FragPos;
     out vec3 Normal;
+    out vec3 BaseColor;
+    #ifdef VERTEX_COLOR
     out vec3 vertexColor;
+    #endif
+    #ifdef TEXTURE
     out vec2 TexCoord;
+    #endif
     
-    uniform mat4 model;
-    uniform mat4 view;
-    uniform mat4 projection;
+    layout (std140) uniform FrameBlock {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 viewPos;
+        vec4 params;
+    } frame;
+    
+    // Um registro por instância do draw (kDrawBlockCapacity = 64)
+    struct DrawData {
+        mat4 model;
+        mat4 normalMatrix;
+        vec4 color;
+    };
+    layout (std140) uniform DrawBlock {
+        DrawData draws[64];
+    };
     
     void main() {
-        vec4 worldPos = model * vec4(aPos, 1.0);
+        DrawData d = draws[gl_InstanceID];
+        vec4 worldPos = d.model * vec4(aPos, 1.0);
         FragPos = worldPos.xyz;
-        Normal = mat3(transpose(inverse(model))) * aNormal;
+        Normal = mat3(d.normalMatrix) * aNormal;
+        BaseColor = d.color.rgb;
+    #ifdef VERTEX_COLOR
+    #ifdef COMPACT_POS
+        vertexColor = aPos; // já em [0,1] dentro da AABB do mesh
+    #else
         vertexColor = (aPos + 1.0) * 0.5;
+    #endif
+    #endif
+    #ifdef TEXTURE
         TexCoord = aTexCoord;
-        gl_Position = projection * view * worldPos;
+    #endif
+        gl_Position = frame.projection * frame.view * worldPos;
     }
 )";
 
 static const char* kFragmentShaderSource = R"(
-    #version 330 core
     out vec4 FragColor;
     
     in vec3 FragPos;
     in vec3 Normal;
+    in vec3 BaseColor;
+    #ifdef VERTEX_COLOR
     in vec3 vertexColor;
+    #endif
+    #ifdef TEXTURE
     in vec2 TexCoord;
-    
-    uniform vec3 baseColor;
-    uniform vec3 lightPos;
-    uniform vec3 viewPos;
-    uniform bool useVertexColor;
-    uniform bool useTexture;
-    uniform bool useWorldTex;
-    uniform float worldTexScale;
     uniform sampler2D ourTexture;
+    #endif
+    
+    layout (std140) uniform FrameBlock {
+        mat4 view;
+        mat4 projection;
+        vec4 lightPos;
+        vec4 viewPos;
+        vec4 params;
+    } frame;
     
     void main() {
-        vec3 color;
-        
-        if (useTexture) {
-            vec2 uv = TexCoord;
-            if (useWorldTex) {
-                uv = FragPos.xz * worldTexScale;
-            }
-            vec3 texColor = texture(ourTexture, uv).rgb;
-            color = texColor;
-        } else if (useVertexColor) {
-            color = vertexColor;
-        } else {
-            color = baseColor;
-        }
+    #if defined(TEXTURE)
+        #ifdef WORLD_TEX
+        vec2 uv = FragPos.xz * frame.params.x;
+        #else
+        vec2 uv = TexCoord;
+        #endif
+        vec3 color = texture(ourTexture, uv).rgb;
+    #elif defined(VERTEX_COLOR)
+        vec3 color = vertexColor;
+    #else
+        vec3 color = BaseColor;
+    #endif
         
         vec3 lightColor = vec3(1.0, 1.0, 1.0);
         // Aumenta luz ambiente para suavizar áreas escuras
@@ -66,7 +104,7 @@ static const char* kFragmentShaderSource = R"(
         
         // Wrap lighting para suavizar o terminador (meia-lambert)
         vec3 norm = normalize(Normal);
-        vec3 lightDir = normalize(lightPos - FragPos);
+        vec3 lightDir = normalize(frame.lightPos.xyz - FragPos);
         float nl = dot(norm, lightDir);
         float wrap = 0.35; // 0 = lambertiano padrão, ~0.3-0.4 suaviza
         float soft = clamp((nl + wrap) / (1.0 + wrap), 0.0, 1.0);
@@ -97,11 +135,18 @@ GLTFRenderer::GLTFRenderer() {
     updateCameraVectors();
     updateCameraView();
     projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.01f, 100.0f);
+    compactArena.format = VertexFormat::Compact;
+}
+
+GLTFRenderer::~GLTFRenderer() {
+    // A thread de simulação usa quase todos os membros: para antes de qualquer um ser destruído
+    stopSimulationThread();
 }
 
-GLuint GLTFRenderer::compileShader(GLenum type, const char* source) {
+GLuint GLTFRenderer::compileShader(GLenum type, const char* source, const std::string& defines) {
     GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
+    const char* parts[3] = { kShaderVersion, defines.c_str(), source };
+    glShaderSource(shader, 3, parts, NULL);
     glCompileShader(shader);
     int success;
     char infoLog[512];
@@ -109,31 +154,91 @@ GLuint GLTFRenderer::compileShader(GLenum type, const char* source) {
     if (!success) {
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
         std::cerr << "ERRO DE COMPILAÇÃO DO SHADER: " << infoLog << std::endl;
+        glDeleteShader(shader);
         return 0;
     }
     return shader;
 }
 
-bool GLTFRenderer::initOpenGL() {
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, kVertexShaderSource);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, kFragmentShaderSource);
-    if (vertexShader == 0 || fragmentShader == 0) return false;
-
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    
+std::string GLTFRenderer::shaderVariantDefines(uint32_t features) const {
+    std::string defines;
+    if (features & SHADER_TEXTURE) defines += "#define TEXTURE 1\n";
+    if (features & SHADER_WORLD_TEX) defines += "#define WORLD_TEX 1\n";
+    if (features & SHADER_VERTEX_COLOR) defines += "#define VERTEX_COLOR 1\n";
+    if (features & SHADER_COMPACT_POS) defines += "#define COMPACT_POS 1\n";
+    return defines;
+}
+
+GLuint GLTFRenderer::buildShaderVariant(uint32_t features) {
+    std::string defines = shaderVariantDefines(features);
+    // Binário do driver em disco (ShaderCache.cpp): pula compilação e link quando a chave confere
+    auto start = std::chrono::steady_clock::now();
+    uint64_t cacheKey = programCacheKey(std::string(kShaderVersion) + defines +
+                                        kVertexShaderSource + "\n" + kFragmentShaderSource);
+    if (GLuint cached = loadCachedProgram(cacheKey)) {
+        bindProgramBlocks(cached);
+        std::cout << "Shader (variante " << features << "): binário em cache carregado em "
+                  << millisecondsSince(start) << " ms" << std::endl;
+        return cached;
+    }
+
+    start = std::chrono::steady_clock::now();
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, kVertexShaderSource, defines);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, kFragmentShaderSource, defines);
+    double compileMs = millisecondsSince(start);
+    if (vertexShader == 0 || fragmentShader == 0) {
+        if (vertexShader) glDeleteShader(vertexShader);
+        if (fragmentShader) glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    start = std::chrono::steady_clock::now();
+    GLuint program = glCreateProgram();
+    if (programBinarySupported) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
     int success;
     char infoLog[512];
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
         std::cerr << "ERRO DE LINKING DO SHADER: " << infoLog << std::endl;
-        return false;
+        glDeleteProgram(program);
+        return 0;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    double linkMs = millisecondsSince(start);
+    std::cout << "Shader (variante " << features << "): compilação " << compileMs << " ms, link "
+              << linkMs << " ms" << std::endl;
+    storeCachedProgram(cacheKey, program);
+    bindProgramBlocks(program);
+    return program;
+}
+
+GLuint GLTFRenderer::shaderVariant(uint32_t features) {
+    // Compilada na primeira vez que um draw pede a combinação; depois vem do cache
+    features &= kShaderVariantCount - 1;
+    ShaderVariant& variant = shaderVariants[features];
+    if (variant.program == 0 && !variant.failed) {
+        variant.program = buildShaderVariant(features);
+        if (variant.program == 0) {
+            variant.failed = true;
+            std::cerr << "Variante de shader " << features << " indisponível; usando a básica" << std::endl;
+        }
+    }
+    return variant.program != 0 ? variant.program : shaderProgram;
+}
+
+bool GLTFRenderer::initOpenGL() {
+    // Variante básica (cor sólida) compilada já aqui: também serve de fallback para as demais
+    initProgramBinaryCache();
+    shaderVariants.assign(kShaderVariantCount, ShaderVariant());
+    shaderProgram = shaderVariant(0);
+    if (shaderVariants[0].failed) return false;
+    initUniformBuffers();
 
     glEnable(GL_DEPTH_TEST);
     glDepthFunc(GL_LESS);
@@ -143,16 +248,4 @@ bool GLTFRenderer::initOpenGL() {
     return true;
 }
 
-void GLTFRenderer::setMatrix4(const std::string& name, const glm::mat4& mat) {
-    glUniformMatrix4fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
-}
-
-void GLTFRenderer::setVec3(const std::string& name, const glm::vec3& vec) {
-    glUniform3fv(glGetUniformLocation(shaderProgram, name.c_str()), 1, glm::value_ptr(vec));
-}
-
-void GLTFRenderer::setBool(const std::string& name, bool value) {
-    glUniform1i(glGetUniformLocation(shaderProgram, name.c_str()), (int)value);
-}
-
 // (sem utilitários de culling)
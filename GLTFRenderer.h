@@ -13,8 +13,22 @@
 #include <sstream>
 #include <map>
 #include <cfloat>
+#include <cstddef>
+#include <cstdint>
 #include <iomanip>
 #include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "JobSystem.h"
+#include "TripleBuffer.h"
+#include "VertexFormat.h"
+#include "MeshOptimize.h"
+#include "SceneGraph.h"
+#include "Animation.h"
 
 // Evite incluir tinygltf aqui com IMPLEMENTATION para não gerar múltiplas definições.
 // Apenas adiante as declarações necessárias.
@@ -25,15 +39,265 @@ class Accessor;
 }
 
 // Estrutura para armazenar dados do mesh
+// A geometria fica na arena compartilhada (GeometryArena); o mesh guarda só os deslocamentos
 struct Mesh {
-    GLuint VAO, VBO, EBO;
+    GLint baseVertex;
+    size_t indexOffset;  // em bytes no EBO da arena
+    GLenum indexType;    // GL_UNSIGNED_SHORT quando o mesh tem menos de 65536 vértices
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     size_t indexCount;
     bool isValid;
     std::string name;
+    // Limites no espaço do nó ao qual o mesh está preso (matrizes estáticas já cozidas nos vértices)
+    glm::vec3 localMin, localMax;
+    int assetNode;       // nó móvel do asset (AssetNode) mais próximo acima do mesh; -1 = raiz do asset
+    // Metadados de porta (decididos no decode e gravados no arquivo cozido)
+    bool isDoor;
+    bool doorHingeLeft;
+    // Vértices no formato compacto (arena própria); dequantize leva [0,1]³ ao espaço do asset
+    bool compact;
+    glm::mat4 dequantize;
+    // Níveis de detalhe (lods[0] = malha completa); indexCount cobre todos os níveis
+    MeshLOD lods[kMaxMeshLods];
+    int lodCount;
+    // Clusters do nível completo (só meshes grandes); o descarte por face traseira exige material de face única
+    std::vector<MeshCluster> clusters;
+    bool doubleSided;
+
+    Mesh() : baseVertex(0), indexOffset(0), indexType(GL_UNSIGNED_INT), indexCount(0), isValid(false),
+             localMin(FLT_MAX), localMax(-FLT_MAX), assetNode(-1), isDoor(false), doorHingeLeft(false),
+             compact(false), dequantize(1.0f), lodCount(1), doubleSided(false) {}
+
+    // Deslocamento em bytes, no EBO da arena, da faixa de índices de um nível
+    size_t lodIndexOffset(int lod) const {
+        return indexOffset + lods[lod].firstIndex * (indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+    }
+};
+
+// Um único VBO/EBO (e VAO) para todos os meshes de um formato de vértice; cresce dobrando a capacidade
+struct GeometryArena {
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    VertexFormat format = VertexFormat::Full;
+    size_t vertexCount = 0, vertexCapacity = 0; // em vértices (vertexFormatBytes(format) cada)
+    size_t indexBytes = 0, indexByteCapacity = 0; // índices de 16 e 32 bits misturados (cada faixa alinhada a 4)
+};
+
+// Instância posicionada no mundo: referência a um mesh compartilhado + matriz
+struct MeshInstance {
+    int meshIndex = -1;
+    int node = -1;                                    // nó do grafo de cena que dá a matriz de mundo
+    int nextInNode = -1;                              // próxima instância do mesmo nó (lista em nodeInstances)
+    int materialId = 0;                               // índice em materials, resolvido pelo nome do mesh ao instanciar
+    int doorIndex = -1;                               // índice em doors, -1 se não for porta
+    int mergeGroup = -1;                              // grupo de multi-draw (estáticos com mesma matriz/cor)
+    int lod = 0;                                      // nível de detalhe atual (mantido entre frames: histerese)
+    bool dynamic = false;                             // o nó já se moveu: fica fora dos grupos de fusão
+};
+
+// Bloco std140 por frame (ponto de ligação 0)
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 lightPos;
+    glm::vec4 viewPos;
+    glm::vec4 params; // x = worldTexScale
+};
+
+// Registro std140 por draw/instância (ponto de ligação 1), lido no shader como draws[gl_InstanceID]
+struct DrawDataGPU {
+    glm::mat4 model;
+    glm::mat4 normalMatrix; // inversa transposta de model (só a parte 3x3 é usada)
+    glm::vec4 color;
+};
+static_assert(sizeof(DrawDataGPU) == 144, "DrawDataGPU deve seguir o layout std140 do shader");
+
+// Registros por ligação do bloco de draw (o shader declara draws[64]; 64 * 144 B < 16 KB mínimos)
+const int kDrawBlockCapacity = 64;
+
+// Anel de UBO para os registros de draw: cada frame mapeia um trecho ainda não usado
+// (sem sincronizar); quando não cabe mais, o buffer é orfanado e o anel recomeça
+struct UniformRing {
+    GLuint buffer = 0;
+    size_t capacity = 0;
+    size_t head = 0;      // primeiro byte livre
+    size_t frameBase = 0; // início do trecho do frame atual
+    size_t alignment = 256;
+};
+
+// Material resolvido no carregamento: nenhuma comparação de string no caminho do frame
+struct Material {
+    glm::vec3 color = glm::vec3(0.82f, 0.82f, 0.82f);
+    GLuint texture = 0;    // 0 = cor sólida
+    bool worldTex = false; // UVs em espaço-mundo (xz * worldTexScale)
+    bool vertexColor = false; // cor derivada da posição (depuração), ignorada se houver textura
+};
+
+// Item da fila de renderização montada a cada frame a partir das instâncias visíveis.
+// Chave (bits altos → baixos): programa | textura | material | mesh | profundidade
+struct DrawItem {
+    uint64_t key = 0;
+    int meshIndex = -1;
+    int lod = 0;
+    int transformIndex = -1; // índice em instances/worldTransforms
+};
+
+// Recursos do shader ligados por #define; cada combinação é um programa separado
+enum ShaderFeature : uint32_t {
+    SHADER_TEXTURE      = 1u << 0, // amostra ourTexture nas UVs do mesh
+    SHADER_WORLD_TEX    = 1u << 1, // UVs em espaço-mundo (só com SHADER_TEXTURE)
+    SHADER_VERTEX_COLOR = 1u << 2, // cor derivada da posição do vértice
+    SHADER_COMPACT_POS  = 1u << 3  // posições unorm16 na AABB do mesh (só muda a cor de SHADER_VERTEX_COLOR)
+};
+const uint32_t kShaderVariantCount = 16;
+
+// Programa de uma combinação de recursos, compilado sob demanda
+struct ShaderVariant {
+    GLuint program = 0;
+    bool failed = false;
+};
+
+// Programa/textura ligados por último (a fila ordenada evita trocas repetidas)
+struct BoundMaterialState {
+    int material = -1;
+    bool compact = false;    // formato de vértice do VAO ligado junto com o material
+    GLuint program = 0;
+    GLuint texture = 0;
+};
+
+// Instâncias consecutivas de um mesh desenhadas com um único glDrawElementsInstanced
+struct InstanceBatch {
+    int meshIndex = -1;
+    int lod = 0;
+    int materialId = 0;
+    int firstInstance = 0;
+    int instanceCount = 0; // no máximo kDrawBlockCapacity (lotes maiores são divididos)
+    size_t uboOffset = 0;  // registros do lote no anel de UBO (relativo ao frame)
+};
+
+// Meshes estáticos distintos que compartilham matriz e cor: um glMultiDrawElementsBaseVertex
+struct MultiDrawGroup {
+    int instanceSlot = 0; // entrada de batchedInstances cujo registro serve a todos os draws do grupo
+    int materialId = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    bool compact = false; // arena dos meshes (só grupos de clusters podem ser compactos)
+    size_t uboOffset = 0;
+    std::vector<GLsizei> counts;
+    std::vector<void*> indexOffsets;
+    std::vector<GLint> baseVertices;
+};
+
+// Arquivo inteiro mapeado somente leitura (mmap); desmapeado no destrutor
+struct MappedFile {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+    bool open(const std::string& path);
+    void close();
+};
+
+// Faixa de memória de um buffer do glTF (vetor do tinygltf ou chunk BIN do .glb mapeado)
+struct BufferSpan {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+// Origem dos bytes de um glTF em decode; buffers[i] corresponde a gltfModel.buffers[i]
+struct GLTFSource {
+    std::unique_ptr<MappedFile> mapping; // .glb mapeado (precisa viver até o fim do decode)
+    std::vector<BufferSpan> buffers;
+};
+
+// AABB simples (sem nome) usada pelo culling
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+};
+
+// Sala para culling por portais (lida de <modelo>.rooms); a sala 0 é implícita: "fora"
+struct Room {
+    std::string name;
+    AABB bounds;
+};
+
+// Passagem entre duas salas. Se o nome for de uma porta, só é atravessável com ela aberta;
+// caso contrário (janelas, vãos) está sempre aberta
+struct Portal {
+    std::string name;
+    int roomA = 0, roomB = 0;
+    int instanceIndex = -1; // instância (da mesma cópia do asset) cujo AABB delimita a passagem
+    int doorIndex = -1;
+};
+
+// Nó da hierarquia de um asset, em pré-ordem (parent < índice do nó; -1 = filho da raiz do asset)
+struct AssetNode {
+    std::string name;
+    int parent = -1;
+    glm::mat4 local = glm::mat4(1.0f);
+};
 
-    Mesh() : VAO(0), VBO(0), EBO(0), indexCount(0), isValid(false) {}
+// Asset carregado uma única vez por caminho de arquivo (parse + upload únicos)
+struct ModelAsset {
+    std::vector<int> meshIndices;
+    std::vector<int> meshNodes;  // nó do asset de cada entrada de meshIndices
+    std::vector<AssetNode> nodes;
+    AnimationSet animations;     // canais apontam para nodes
+    std::vector<Room> rooms;     // de <modelo>.rooms, no espaço do asset (rooms[0] = "fora"; vazio sem arquivo)
+    std::vector<Portal> portals; // salas em índices de rooms; instâncias resolvidas a cada cópia
+    size_t vertexBytes = 0;      // ocupados na arena
+    size_t vertexBytesSaved = 0; // em relação ao formato completo (32 B/vértice)
+};
+
+// Mesh pronto na CPU aguardando upload. Os ponteiros apontam para o arquivo cozido mapeado
+// ou para mesh.vertices/indices (quando veio do decode)
+struct StagedMesh {
+    Mesh mesh;
+    const float* vertices = nullptr;
+    size_t vertexCount = 0;
+    std::vector<CompactVertex> compactVertices; // preenchido (no lugar de vertices) no formato compacto
+    const void* indices = nullptr;
+    size_t indexCount = 0;
+    unsigned indexSize = 4;                     // 2 ou 4 bytes
+    std::vector<uint16_t> shortIndices;         // índices estreitados do decode (o cozido já vem em 16 bits)
+};
+
+// Resultado da etapa de CPU de um asset (sem GL: roda em qualquer thread)
+struct StagedAsset {
+    std::unique_ptr<MappedFile> mapping; // mantém os ponteiros de StagedMesh válidos
+    std::vector<StagedMesh> meshes;
+    std::vector<AssetNode> nodes;
+    AnimationSet animations;
+    std::vector<Room> rooms;
+    std::vector<Portal> portals;
+};
+
+// Estado de um pedido de carregamento assíncrono
+enum class LoadStatus { Pending, Ready, Failed };
+typedef int LoadHandle;
+
+// Leitura/decode de um arquivo em uma thread do pool; pedidos do mesmo arquivo compartilham o job
+struct AsyncAssetJob {
+    std::string filepath;
+    VertexFormat format = VertexFormat::Full;
+    StagedAsset staged;        // escrito pela thread de fundo antes de done
+    bool ok = false;
+    std::atomic<bool> done{false};
+    ModelAsset asset;          // preenchido na thread do GL
+    size_t nextMesh = 0;       // próximo mesh de staged a enviar
+};
+
+// Pedido de loadGLTF*Async: instanciado em ordem de chamada quando o asset termina de subir
+struct AsyncLoadRequest {
+    std::string filepath;
+    glm::mat4 transform = glm::mat4(1.0f);
+    bool snapToGround = false; // Y resolvido ao instanciar (o chão pode ainda estar carregando)
+    glm::vec3 groundPos = glm::vec3(0.0f);
+    std::shared_ptr<AsyncAssetJob> job;
+    LoadStatus status = LoadStatus::Pending;
 };
 
 // Estrutura para bounding box de colisão
@@ -48,38 +312,203 @@ struct BoundingBox {
     }
 };
 
+// AABB de mundo de uma caixa local transformada (exata para translação e rotações de 90°)
+AABB transformAABB(const glm::mat4& m, const glm::vec3& localMin, const glm::vec3& localMax);
+
+// FNV-1a de 64 bits (chaves do cache de shaders e validação do cache de meshes)
+uint64_t fnv1a64(const void* data, size_t size, uint64_t hash = 1469598103934665603ull);
+
+struct Frustum;
+// Classificação de uma AABB contra o frustum: 0 = fora, 1 = cruza, 2 = totalmente dentro
+int classifyAABB(const Frustum& f, const AABB& b);
+
+// Nó da BVH sobre as AABBs das instâncias; folhas guardam uma faixa de bvhItems
+struct BVHNode {
+    AABB bounds;
+    int left = -1, right = -1; // filhos (-1 nas folhas)
+    int parent = -1;
+    int first = 0, count = 0;  // faixa em bvhItems (somente folhas)
+};
+
+// Subárvore da BVH percorrida por um job do culling paralelo (inside: já classificada como dentro)
+struct CullTask {
+    int node = -1;
+    bool inside = false;
+};
+
+// Planos do frustum em SoA (6 planos + 2 de preenchimento) para o teste SIMD
+struct Frustum {
+    alignas(16) float nx[8];
+    alignas(16) float ny[8];
+    alignas(16) float nz[8];
+    alignas(16) float d[8];
+};
+
+// Contadores do último frame (para verificar o ganho do culling)
+struct RenderStats {
+    int instancesTotal = 0;
+    int instancesDrawn = 0;
+    int instancesCulled = 0;
+    int drawCalls = 0;
+    int roomsVisible = 0;
+    int roomsTotal = 0;
+    int instancesOccluded = 0; // escondidas pelo resultado das consultas de oclusão
+    int occlusionQueries = 0;  // consultas emitidas neste frame
+    int drawsSaved = 0;        // comandos de desenho (lotes/entradas de multi-draw) evitados pela oclusão
+    int trianglesDrawn = 0;    // depois da escolha de LOD e do culling de clusters
+    int instancesReduced = 0;  // instâncias desenhadas em um nível simplificado
+    int clustersTested = 0;
+    int clustersCulled = 0;    // fora do frustum ou de costas para a câmera
+};
+
+// Consulta de oclusão de uma instância (resultado lido no frame seguinte, sem esperar a GPU)
+struct OcclusionState {
+    GLuint query = 0;
+    bool pending = false;          // consulta emitida e resultado ainda não lido
+    bool occluded = false;         // último resultado: nenhuma amostra passou no teste de profundidade
+    unsigned queryFrame = 0;       // frame em que a consulta pendente foi emitida
+    unsigned lastCandidateFrame = 0; // último frame em que passou pelo frustum/portais
+};
+
 // Estrutura para portas
 struct Door {
     std::string name;
-    int meshIndex = -1;
+    int instanceIndex = -1;
     BoundingBox box;
     bool hingeLeft = true;
     bool isOpen = false;
-    float angle = 0.0f;
+    float angle = 0.0f;                     // lido do clipe da porta (-90..90, 0 = fechada)
     float target = 0.0f;
-    float speed = 180.0f;
+    float speed = 180.0f;                   // graus por segundo
     glm::vec3 hinge;
+    int node = -1;                          // a rotação vai na matriz local deste nó
+    glm::mat4 closedLocal = glm::mat4(1.0f);
+    int clip = -1;                          // clipe em animations: ângulo -90..90 ao longo do tempo
 };
 
+// Teclas de movimento mantidas pressionadas (thread de janela -> simulação); índices = direção de
+// processMovement, processVerticalMovement e processKeyboardRotation
+struct SimInput {
+    bool move[4] = { false, false, false, false };
+    bool vertical[2] = { false, false };
+    bool rotate[4] = { false, false, false, false };
+};
+
+// Estado publicado pela simulação ao fim de cada tick. Imutável depois de publicado (TripleBuffer)
+struct FrameSnapshot {
+    uint64_t tick = 0;                      // 0 = nada publicado ainda
+    double time = 0.0;                      // relógio da simulação no fim do tick (s)
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    float yaw = 0.0f, pitch = 0.0f;
+    std::vector<float> doorAngles;          // doors[i].angle
+    bool doorsMoving = false;               // alguma porta fora do alvo
+    std::vector<NodePose> poses;            // todos os nós animados (portas e clipes dos assets)
+};
+
+// O que o frame desenha: câmera e portas copiadas da simulação ou interpoladas entre snapshots
+struct FrameState {
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    glm::mat4 view = glm::mat4(1.0f);
+    std::vector<float> doorAngles;
+    bool doorsMoving = false;
+};
+
+// Matriz de visão da câmera em primeira pessoa (mesmos eixos de updateCameraVectors)
+glm::mat4 cameraViewMatrix(const glm::vec3& position, float yaw, float pitch);
+
 class GLTFRenderer {
 private:
     std::vector<Mesh> meshes;
+    // Instâncias no mundo; collisionBoxes[i] é a AABB de instances[i]
+    std::vector<MeshInstance> instances;
     std::vector<BoundingBox> collisionBoxes;
-    GLuint shaderProgram;
+    std::unordered_map<std::string, ModelAsset> assetCache;
+
+    // Carregamento assíncrono (Streaming.cpp)
+    std::vector<AsyncLoadRequest> loadRequests;  // índice = LoadHandle
+    size_t nextLoadRequest = 0;                  // primeiro pedido ainda não instanciado
+    std::unordered_map<std::string, std::shared_ptr<AsyncAssetJob>> assetJobsInFlight;
+
+    // Geometria estática e dinâmica em um único par de buffers por formato de vértice
+    GeometryArena arena;
+    GeometryArena compactArena;
+    size_t vertexBytesSavedTotal = 0;
+
+    // Desenho instanciado: instâncias agrupadas por mesh; dados por draw em UBOs (UniformBuffers.cpp)
+    GLuint frameUBO = 0;
+    UniformRing drawRing;
+    std::vector<int> batchedInstances;        // índices de instances ordenados por mesh
+    std::vector<InstanceBatch> instanceBatches;  // lotes instanciados (vários objetos ou dinâmicos)
+    std::vector<MultiDrawGroup> multiDrawGroups; // lotes estáticos unitários fundidos
+    std::vector<glm::mat4> worldTransforms;   // matriz de mundo de cada instância (atualizada só quando muda)
+    std::vector<glm::mat4> normalTransforms;  // inversa transposta de worldTransforms
+
+    // Grafo de cena: cada instância aponta para um nó; mover um nó atualiza só as instâncias da subárvore
+    SceneGraph scene;
+    std::vector<int> nodeInstances;           // primeira instância de cada nó (-1 = nenhuma)
+    std::vector<int> changedNodes;            // saída de scene.updateWorld (reaproveitado entre frames)
+
+    // Animações: clipes dos assets (glTF) e das portas, avaliados juntos a cada passo da simulação (Animation.cpp)
+    AnimationSystem animations;
+    std::vector<int> modelClips;              // clipes importados dos assets (sem os das portas)
+    bool modelAnimationsPlaying = false;
+
+    // Fila de renderização e materiais (RenderQueue.cpp)
+    std::vector<Material> materials;
+    std::unordered_map<std::string, int> materialIndexByName; // usado só no carregamento
+    std::vector<DrawItem> renderQueue, renderQueueScratch;
+    BoundMaterialState boundMaterial;
+    int chaoMaterialId = -1;
+    bool instanceBatchesDirty = true;
+    int mergeGroupCount = 0;
+
+    // Culling por frustum: BVH sobre as AABBs de mundo das instâncias
+    std::vector<AABB> instanceBounds;         // instanceBounds[i] pertence a instances[i] (sem folga)
+    std::vector<BVHNode> bvhNodes;
+    std::vector<int> bvhRoots;                // uma raiz por grupo: [0] = global, [1 + sala]
+    std::vector<int> bvhItems;                // índices de instâncias, agrupados por folha
+    std::vector<int> instanceLeaf;            // folha que contém cada instância
+    std::vector<int> visibleInstances;        // saída do culling do frame atual
+    std::vector<CullTask> cullTasks, cullTasksNext;   // subárvores do culling paralelo
+    std::vector<std::vector<int>> cullOutputs;        // visíveis por subárvore (concatenadas na ordem)
+    bool bvhDirty = true;
+    bool frustumCullingEnabled = true;
+    bool lodEnabled = true;
+    bool clusterCullingEnabled = true;
+    Frustum cullFrustum;                      // frustum do frame (reusado no culling de clusters)
+    float lodPixelsPerUnit = 0.0f;            // pixels por unidade de mundo a 1 m da câmera (do frame atual)
+    RenderStats stats;
+
+    // Culling por salas/portais (Rooms.cpp)
+    std::vector<Room> rooms;                  // rooms[0] = "fora"
+    std::vector<Portal> portals;
+    std::vector<int> instanceRoom;            // sala de cada instância; -1 = global (paredes, portas, piso)
+    std::vector<char> visibleRooms;
+    std::vector<int> roomQueue;               // fila da busca em largura de computeVisibleRooms (reusada)
+    bool portalCullingEnabled = true;
+
+    // Culling por oclusão (Occlusion.cpp): GL_ANY_SAMPLES_PASSED sobre a AABB de cada instância
+    std::vector<OcclusionState> occlusion;    // occlusion[i] pertence a instances[i]
+    std::vector<int> occlusionQueries;        // instâncias testadas no fim do frame atual
+    std::vector<int> occludedInstances;       // escondidas neste frame
+    std::vector<char> meshSeen;               // auxiliar para contar draws evitados
+    Mesh occlusionBox;                        // cubo [-1,1]³ na arena, desenhado nas consultas
+    bool occlusionCullingEnabled = true;
+    unsigned frameIndex = 0;
+    glm::vec3 lastOcclusionCameraPos = glm::vec3(FLT_MAX);
+    GLuint shaderProgram = 0;                 // variante básica (sem recursos)
+    std::vector<ShaderVariant> shaderVariants; // índice = máscara de ShaderFeature
+    bool programBinarySupported = false;      // GL_ARB_get_program_binary (ShaderCache.cpp)
+    std::string driverSignature;              // GL_VENDOR/GL_RENDERER/GL_VERSION, parte da chave do cache
     glm::mat4 model, view, projection;
 
     // Portas
     std::vector<Door> doors;
     std::unordered_map<std::string, int> doorIndexByName;
 
-    // Variáveis para armazenar as dimensões do modelo
-    glm::vec3 modelSize;
-    glm::vec3 modelCenter;
-
     // Chão
     GLuint floorVAO = 0, floorVBO = 0;
     glm::vec3 floorColor = glm::vec3(1.0f, 1.0f, 1.0f);
-    glm::vec3 floorMin, floorMax;
 
     // Texturas
     GLuint floorTexture = 0;
@@ -87,7 +516,7 @@ private:
     GLuint chaoTexture = 0;
     bool useFloorTexture = false;
     int textureType = 0;
-    int chaoMeshIndex = -1;
+    int chaoInstanceIndex = -1;
     float chaoWorldTexScale = 0.5f;
 
     // Camera variables
@@ -107,43 +536,156 @@ private:
     bool firstMouse;
     float lastX, lastY;
     float lastGroundY = 0.0f;
-    float groundFollowLerp = 0.5f;
+    float groundFollowRate = 41.6f; // 1/s: cada passo anda 1 - e^(-taxa * dt) até o chão (metade por quadro a 60 Hz)
+
+    // Estado desenhado pelo frame atual; o caminho de render() só lê daqui (nunca cameraPos, view ou doors)
+    FrameState frameState;
+
+    // Thread de simulação (Simulation.cpp): câmera, portas, colisão e animações num tick fixo, publicadas em
+    // snapshots. simMutex protege o estado da simulação das cargas e comandos que chegam pela thread do GL
+    std::thread simThread;
+    std::atomic<bool> simStopping{false};
+    std::mutex simMutex;
+    std::mutex simInputMutex;
+    SimInput simInput;
+    TripleBuffer<FrameSnapshot> snapshots;
+    FrameSnapshot previousSnapshot;           // snapshot anterior ao atual (visto pela thread do GL)
+    std::vector<glm::mat4> appliedPoseLocals; // última local gravada por nó animado (evita setLocal repetida)
+
+    // Simulação na thread do GL (updateSimulation): passos fixos, resto no acumulador; o frame interpola
+    // entre os estados dos dois últimos passos com simAlpha = resto / passo
+    int64_t simAccumulator = 0;               // em ns × passos por segundo (um passo = 1e9, sem arredondamento)
+    uint64_t simTick = 0;
+    float simAlpha = 1.0f;
+    FrameSnapshot stepPrevious, stepCurrent;
 
     // Shaders are defined in the .cpp at file scope
 
+    // Sistema de jobs (carregamento, culling, fila de renderização, física). Último membro: é destruído
+    // primeiro, então jobs ainda na fila terminam antes dos demais membros sumirem
+    std::unique_ptr<JobSystem> workers;
+
     // Métodos privados
-    bool loadPrimitive(const tinygltf::Primitive& primitive,
-                       const tinygltf::Model& model,
-                       const std::vector<unsigned char>& binaryData,
-                       const std::string& meshName = "",
-                       const glm::mat4& nodeTransform = glm::mat4(1.0f));
+    const ModelAsset* acquireModelAsset(const std::string& filepath, VertexFormat format);
+    void addInstance(int meshIndex, const glm::mat4& transform);
+    void addInstanceAtNode(int meshIndex, int node);
+    int addSceneNode(int parent, const glm::mat4& local, const std::string& name);
+    // Mover um nó (matriz local) move a subárvore inteira no próximo frame, sem reenvio de buffers
+    void setNodeTransform(int node, const glm::mat4& local);
+    void updateSceneTransforms();
+    int buildDoorClip(const Door& door);
+    void syncDoorsWithClips();
+
+    // Simulação (Simulation.cpp)
+    void advanceSimulation(float deltaTime, const SimInput& input);
+    void followGround(float deltaTime);
+    void simulationLoop();
+    void writeSnapshot(FrameSnapshot& snapshot, uint64_t tick, double time);
+    void applySnapshots(const FrameSnapshot& previous, const FrameSnapshot& current, float alpha);
+    void consumeSnapshots();
+    void captureFrameState();
+    void instantiateAsset(const std::string& filepath, const ModelAsset& asset, const glm::mat4& baseTransform);
+    bool stageModelAsset(const std::string& filepath, VertexFormat format, StagedAsset& staged);
+    bool commitStagedMesh(StagedMesh& staged, ModelAsset& asset);
+    void reportVertexMemory(const std::string& filepath, const ModelAsset& asset) const;
+    LoadHandle queueAsyncLoad(const std::string& filepath, const glm::mat4& transform,
+                              bool snapToGround, const glm::vec3& groundPos, VertexFormat format);
+    bool parseGLTFFile(const std::string& filepath, tinygltf::Model& gltfModel, GLTFSource& source) const;
+    void decodeModel(const tinygltf::Model& gltfModel, const GLTFSource& source, std::vector<Mesh>& out,
+                     std::vector<AssetNode>& nodes, AnimationSet& animations);
+    void decodeAnimations(const tinygltf::Model& gltfModel, const GLTFSource& source,
+                          const std::vector<int>& assetNodeOf, AnimationSet& animations) const;
+    JobSystem& jobSystem();
+    bool decodePrimitive(const tinygltf::Primitive& primitive,
+                         const tinygltf::Model& model,
+                         const std::vector<BufferSpan>& buffers,
+                         const std::string& meshName,
+                         const glm::mat4& transform,
+                         Mesh& mesh) const;
     
-    bool loadAccessorData(const tinygltf::Accessor& accessor,
-                          const tinygltf::Model& model,
-                          const std::vector<unsigned char>& binaryData,
-                          std::vector<float>& out,
-                          bool isTexCoord = false);
+    bool decodeAccessor(const tinygltf::Accessor& accessor,
+                        const tinygltf::Model& model,
+                        const std::vector<BufferSpan>& buffers,
+                        float* dst, size_t dstStride, int components, size_t count,
+                        bool isTexCoord = false) const;
     
     bool loadAccessorIndices(const tinygltf::Accessor& accessor, 
                              const tinygltf::Model& model, 
-                             const std::vector<unsigned char>& binaryData, 
-                             std::vector<unsigned int>& indices);
+                             const std::vector<BufferSpan>& buffers,
+                             std::vector<unsigned int>& indices) const;
+
+    // Cache de meshes cozidos (MeshCache.cpp)
+    bool stageCookedModel(const std::string& filepath, StagedAsset& staged) const;
+    bool writeCookedModel(const std::string& filepath, const tinygltf::Model& gltfModel,
+                          const std::vector<Mesh>& decoded, const std::vector<AssetNode>& nodes,
+                          const AnimationSet& animations) const;
     
-    GLuint compileShader(GLenum type, const char* source);
+    GLuint compileShader(GLenum type, const char* source, const std::string& defines);
+    std::string shaderVariantDefines(uint32_t features) const;
+    GLuint buildShaderVariant(uint32_t features);
+    GLuint shaderVariant(uint32_t features);
+    uint32_t materialShaderFeatures(int materialId, bool compact) const;
+    void initProgramBinaryCache();
+    uint64_t programCacheKey(const std::string& shaderText) const;
+    GLuint loadCachedProgram(uint64_t key);
+    void storeCachedProgram(uint64_t key, GLuint program);
+    void useProgram(GLuint program);
     bool setupMeshBuffers(Mesh& mesh);
-    void setMatrix4(const std::string& name, const glm::mat4& mat);
-    void setVec3(const std::string& name, const glm::vec3& vec);
-    void setBool(const std::string& name, bool value);
+    // vertices: floats intercalados, ou CompactVertex se mesh.compact
+    bool uploadMeshGeometry(Mesh& mesh, const void* vertices, size_t vertexCount,
+                            const void* indices, size_t indexCount, unsigned indexSize);
+    GeometryArena& arenaFor(const Mesh& mesh) { return mesh.compact ? compactArena : arena; }
+    void ensureArenaCapacity(GeometryArena& target, size_t extraVertices, size_t extraIndexBytes);
+    void rebuildInstanceBatches();
+    void buildDrawLists();
+    glm::mat4 instanceWorldMatrix(int instanceIndex) const;
+    int materialForMesh(const std::string& meshName);
+    void buildRenderQueue();
+    void bindMaterial(int materialId, bool compact);
+    int selectInstanceLod(int instanceIndex);
+    bool appendVisibleClusters(int instanceIndex, MultiDrawGroup& group);
+    void setInstanceTransform(int instanceIndex, const glm::mat4& world);
+
+    // UBOs (UniformBuffers.cpp)
+    void initUniformBuffers();
+    void bindProgramBlocks(GLuint program);
+    void updateFrameUniforms();
+    size_t reserveDrawRecords(size_t& cursor, size_t count) const;
+    DrawDataGPU* mapDrawRecords(size_t bytes);
+    void bindDrawRecords(size_t offset);
+    void writeInstanceRecord(DrawDataGPU& out, int instanceIndex) const;
     GLuint createTextureFromFile(const std::string& path, bool flipY = false);
     void updateCameraVectors();
     void updateCameraView();
     bool checkCollision(const glm::vec3& newPos);
     float groundHeightAt(const glm::vec3& posXZ);
 
-    // (sem otimizações de culling)
+    // Culling (Culling.cpp)
+    void buildBVH();
+    int buildBVHNode(int first, int count, const std::vector<glm::vec3>& centroids, int parent);
+    void refitInstance(int instanceIndex);
+    void cullInstances();
+    void cullBVH(int root, bool inside, const Frustum& frustum, std::vector<int>& out) const;
+    void cullBVHParallel(const Frustum& frustum);
+
+    // Salas e portais (Rooms.cpp)
+    bool parseRooms(const std::string& roomsPath, std::vector<Room>& outRooms, std::vector<Portal>& outPortals) const;
+    void addRooms(const std::vector<Room>& assetRooms, const std::vector<Portal>& assetPortals,
+                  const glm::mat4& baseTransform, size_t firstInstance);
+    void assignRooms();
+    int roomAt(const glm::vec3& pos) const;
+    void computeVisibleRooms(const Frustum& frustum);
+
+    // Oclusão (Occlusion.cpp)
+    void createOcclusionBox();
+    void applyOcclusion();
+    void countSavedDraws();
+    glm::mat4 occlusionBoxMatrix(int instanceIndex) const;
+    void issueOcclusionQueries(size_t firstOffset, size_t stride);
 
 public:
     GLTFRenderer();
+    ~GLTFRenderer();
     
     // Texturas
     GLuint createCheckerboardTexture(int width, int height, int checkerSize);
@@ -156,8 +698,10 @@ public:
     
     // GLTF
     bool loadGLTF(const std::string& filepath);
-    // Carregar com transformação base adicional (para posicionar itens no mundo)
-    bool loadGLTF(const std::string& filepath, const glm::mat4& baseTransform);
+    // Carregar com transformação base adicional (para posicionar itens no mundo). O formato de vértice
+    // vale para o primeiro carregamento do arquivo (cargas seguintes reutilizam o asset já enviado)
+    bool loadGLTF(const std::string& filepath, const glm::mat4& baseTransform,
+                  VertexFormat format = VertexFormat::Full);
     // Carregar em uma posição do mundo (Y ajustado ao chão)
     bool loadGLTFAt(const std::string& filepath, const glm::vec3& worldPos);
     // Carregar em uma posição do mundo com rotação no eixo Z (graus). Y é ajustado ao chão
@@ -168,15 +712,48 @@ public:
     bool loadGLTFAtNear(const std::string& filepath, const std::string& anchorMesh, const glm::vec2& offsetXZ);
     // Carregar sobre o 'chao' usando deslocamento XZ relativo ao centro do chao (Y ajustado ao chão)
     bool loadGLTFAtOnChao(const std::string& filepath, const glm::vec2& offsetXZFromCenter);
+    // Carregamento assíncrono: leitura e decode no pool, upload em pumpAsyncLoads (thread do GL)
+    LoadHandle loadGLTFAsync(const std::string& filepath, const glm::mat4& baseTransform = glm::mat4(1.0f),
+                             VertexFormat format = VertexFormat::Full);
+    // Como loadGLTFAt: Y ajustado ao chão no momento em que o objeto é instanciado
+    LoadHandle loadGLTFAtAsync(const std::string& filepath, const glm::vec3& worldPos,
+                               VertexFormat format = VertexFormat::Full);
+    // Envia meshes prontos e instancia pedidos concluídos até esgotar o orçamento (ms)
+    void pumpAsyncLoads(double budgetMs);
+    LoadStatus loadStatus(LoadHandle handle) const;
+    int pendingAsyncLoads() const { return (int)(loadRequests.size() - nextLoadRequest); }
+    // Memória de vértices economizada pelos assets carregados no formato compacto
+    size_t vertexBytesSaved() const { return vertexBytesSavedTotal; }
+    // Gerar/atualizar o arquivo cozido (.tjmesh) sem contexto OpenGL
+    bool cookModel(const std::string& filepath);
     void initDoors();
+
+    // Animações dos assets: todos os clipes com esse nome (um por instância do asset); retorna quantos
+    int playAnimation(const std::string& name, bool loop = false);
+    int stopAnimation(const std::string& name);
+    void toggleAnimations(); // todos os clipes dos assets em loop / parados
     
     // Renderização
     void render();
+    void toggleFrustumCulling();
+    void togglePortalCulling();
+    void toggleOcclusionCulling();
+    void toggleLod();
+    void toggleClusterCulling();
+    const RenderStats& getRenderStats() const { return stats; }
     
     // Movimento e controles
     void processMovement(int direction, float deltaTime);
     void processVerticalMovement(int direction, float deltaTime); // Shift=subir, Space=descer
-    void updateDoors(float deltaTime);
+
+    // Simulação em passos fixos de 1/120 s (câmera, portas, animações): updateSimulation avança o tempo
+    // decorrido na thread que chama e render() interpola entre os dois últimos passos. Com a thread de
+    // simulação ligada os passos são dela, a janela só envia as teclas
+    void updateSimulation(double elapsedSeconds, const SimInput& input);
+    void startSimulationThread();
+    void stopSimulationThread();
+    bool simulationThreadRunning() const { return simThread.joinable(); }
+    void setSimulationInput(const SimInput& input);
     void toggleNearestDoor();
     void rotate(float yawOffset, float pitchOffset);
     void processKeyboardRotation(int direction, float deltaTime);
@@ -0,0 +1,198 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+
+// Fila da thread atual: workers usam a própria; qualquer outra thread, a compartilhada
+static thread_local const JobSystem* tlsSystem = nullptr;
+static thread_local int tlsQueue = -1;
+
+// Espera ativa antes de cochilar (o fim de um parallelFor costuma estar a microssegundos)
+static const int kWaitSpins = 1000;
+
+JobSystem::JobSystem(int workerCount) {
+    if (workerCount < 0) {
+        unsigned cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? (int)cores - 1 : 1;
+    }
+    for (int i = 0; i <= workerCount; ++i) queues.emplace_back(new WorkQueue());
+    threads.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    // Workers esvaziam as filas antes de sair (jobs de carregamento já enfileirados terminam)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void JobSystem::run(std::function<void()> job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    push(Job{ std::move(job), counter });
+}
+
+void JobSystem::runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter) {
+    if (counter) counter->pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        // Mesma trava do último finish de dependency: ou a continuação entra na lista antes, ou o contador já zerou
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.pending.load(std::memory_order_acquire) != 0) {
+            dependency.continuations.emplace_back(std::move(job), counter);
+            return;
+        }
+    }
+    push(Job{ std::move(job), counter });
+}
+
+void JobSystem::runBackground(std::function<void()> job) {
+    if (threads.empty()) {
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(background.mutex);
+        background.jobs.push_back(Job{ std::move(job), nullptr });
+    }
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    int spins = 0;
+    while (!counter.done()) {
+        if (tryRunOne()) {
+            spins = 0;
+        } else if (++spins < kWaitSpins) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    // O último finish ainda pode estar com a trava do contador: depois daqui ele pode ser destruído
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || threads.empty()) {
+        body(0, count);
+        return;
+    }
+    // A primeira faixa fica com a thread que chama; as outras vão para a fila dela (roubadas pelos workers)
+    JobCounter counter;
+    for (size_t c = 1; c < chunks; ++c) {
+        size_t begin = c * grain, end = std::min(count, begin + grain);
+        run([&body, begin, end] { body(begin, end); }, &counter);
+    }
+    body(0, std::min(count, grain));
+    wait(counter);
+}
+
+void JobSystem::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    parallelFor(count, 1, [&body](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) body(i);
+    });
+}
+
+void JobSystem::push(Job job) {
+    int queue = tlsSystem == this ? tlsQueue : (int)queues.size() - 1;
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->jobs.push_back(std::move(job));
+    }
+    queued.fetch_add(1);
+    // Só acorda alguém se houver worker dormindo (sleeping é lido depois de queued: nenhum acordar se perde)
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_one();
+    }
+}
+
+bool JobSystem::popOwn(int queue, Job& job) {
+    WorkQueue& q = *queues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.jobs.empty()) return false;
+    job = std::move(q.jobs.back());
+    q.jobs.pop_back();
+    queued.fetch_sub(1);
+    return true;
+}
+
+bool JobSystem::steal(int thief, Job& job) {
+    int n = (int)queues.size();
+    for (int k = 1; k < n; ++k) {
+        WorkQueue& q = *queues[(thief + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.jobs.empty()) continue;
+        job = std::move(q.jobs.front());
+        q.jobs.pop_front();
+        queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::tryRunOne() {
+    // Quem não é worker só ajuda com a fila compartilhada: roubar de um worker poderia trazer para a thread
+    // do GL um pedaço de decode de centenas de ms no meio de um frame
+    bool worker = tlsSystem == this;
+    int queue = worker ? tlsQueue : (int)queues.size() - 1;
+    Job job;
+    if (!popOwn(queue, job) && !(worker && steal(queue, job))) return false;
+    execute(job);
+    return true;
+}
+
+bool JobSystem::tryRunBackground() {
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(background.mutex);
+        if (background.jobs.empty()) return false;
+        job = std::move(background.jobs.front());
+        background.jobs.pop_front();
+    }
+    queued.fetch_sub(1);
+    execute(job);
+    return true;
+}
+
+void JobSystem::execute(Job& job) {
+    job.fn();
+    job.fn = nullptr; // libera as capturas antes de sinalizar o contador
+    finish(job.counter);
+}
+
+void JobSystem::finish(JobCounter* counter) {
+    if (!counter) return;
+    std::vector<std::pair<std::function<void()>, JobCounter*>> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+        ready.swap(counter->continuations);
+    }
+    // Contadores das continuações já foram somados em runAfter
+    for (auto& continuation : ready) push(Job{ std::move(continuation.first), continuation.second });
+}
+
+void JobSystem::workerLoop(int index) {
+    tlsSystem = this;
+    tlsQueue = index;
+    for (;;) {
+        if (tryRunOne() || tryRunBackground()) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && queued.load() == 0) return;
+        sleeping.fetch_add(1);
+        wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+        sleeping.fetch_sub(1);
+    }
+}
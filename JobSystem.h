@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Contador de dependências: run(job, &counter) soma 1, o fim do job subtrai 1. wait(counter) espera o zero
+// executando outros jobs; runAfter(counter, job) agenda o job só quando o contador zerar
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int> pending{0};
+    std::mutex mutex;
+    std::vector<std::pair<std::function<void()>, JobCounter*>> continuations;
+};
+
+// Sistema de jobs com roubo de trabalho: cada worker tem sua deque (o dono tira do fim, LIFO, quem rouba
+// tira do início). Threads de fora (thread do GL) usam uma deque compartilhada e, ao esperar, executam jobs
+// só dela (nunca um job longo roubado de um worker). Usado no decode de assets, no culling e na fila de
+// renderização, e nas consultas de física
+class JobSystem {
+public:
+    // workerCount < 0: núcleos disponíveis - 1 (a thread que espera também trabalha); 0 = tudo na thread que espera
+    explicit JobSystem(int workerCount = -1);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void run(std::function<void()> job, JobCounter* counter = nullptr);
+    void runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+    void wait(JobCounter& counter);
+    // Job longo sem prazo (carregamento assíncrono): só workers ociosos o executam, nunca quem espera um frame
+    void runBackground(std::function<void()> job);
+
+    // body(begin, end) em faixas de até grain índices; retorna quando todas terminam.
+    // Pode ser chamado de dentro de um job (a thread ajuda enquanto espera)
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+    // Um índice por job (itens de custo muito diferente, como primitivas no decode)
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    unsigned threadCount() const { return (unsigned)threads.size(); } // workers, sem a thread que espera
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        JobCounter* counter = nullptr;
+    };
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    bool popOwn(int queue, Job& job);
+    bool steal(int thief, Job& job);
+    bool tryRunOne();
+    bool tryRunBackground();
+    void execute(Job& job);
+    void finish(JobCounter* counter);
+    void workerLoop(int index);
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // uma por worker + a compartilhada (última)
+    WorkQueue background;
+    std::atomic<int> queued{0};
+    std::atomic<int> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{false};
+};
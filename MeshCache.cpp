@@ -0,0 +1,450 @@
+#include "GLTFRenderer.h"
+#include "MeshOptimize.h"
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../tjal-modelC/lib/tinygltf/tiny_gltf.h"
+
+// Arquivo cozido ao lado do .gltf (models/TJAL.gltf -> models/TJAL.tjmesh):
+//   cabeçalho | dependências | nós | clipes | canais | meshes | nomes | tempos/valores das animações |
+//   blobs de vértices/índices/clusters (alinhados a 16)
+// Nós da hierarquia em pré-ordem com a matriz local; canais de animação apontando para esses nós, com
+// faixas dos arrays de tempos e valores; vértices intercalados (pos, normal, uv) no espaço do nó móvel
+// (animado ou porta) mais próximo acima do mesh, ou da raiz do asset, e otimizados (solda, ordem para o
+// cache); índices em 16 bits quando o mesh tem menos de 65536 vértices, com os níveis de detalhe em
+// sequência depois da malha completa
+static const uint32_t kCookedMagic = 0x4B4D4A54; // "TJMK"
+static const uint32_t kCookedVersion = 8;        // mudar sempre que o decode ou o layout mudar
+static const uint32_t kCookedMeshDoor = 1u << 0;
+static const uint32_t kCookedMeshHingeLeft = 1u << 1;
+static const uint32_t kCookedMeshDoubleSided = 1u << 2;
+static const size_t kCookedBlobAlignment = 16;
+
+struct CookedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t meshCount;
+    uint32_t dependencyCount;
+    uint32_t nodeCount;
+    uint32_t clipCount;
+    uint32_t channelCount;
+    uint32_t timeCount;    // floats em timeOffset
+    uint32_t valueCount;   // floats em valueOffset
+    uint32_t reserved;
+    uint64_t dependencyOffset;
+    uint64_t nodeOffset;
+    uint64_t clipOffset;
+    uint64_t channelOffset; // AnimationChannel[channelCount]
+    uint64_t timeOffset;
+    uint64_t valueOffset;
+    uint64_t meshOffset;
+    uint64_t stringOffset;
+    uint64_t fileSize;
+};
+
+// Arquivo de origem (o .gltf e seus .bin externos): tamanho + mtime, com hash como desempate
+struct CookedDependency {
+    uint64_t size;
+    int64_t mtimeNs;
+    uint64_t hash;
+    uint32_t pathOffset, pathLength; // relativo a stringOffset
+};
+
+struct CookedNode {
+    int32_t parent;        // índice de nó anterior (pré-ordem) ou -1
+    uint32_t nameOffset, nameLength;
+    float local[16];       // coluna a coluna, como glm::mat4
+};
+
+struct CookedClip {
+    uint32_t nameOffset, nameLength;
+    uint32_t firstChannel, channelCount;
+    float duration;
+};
+
+struct CookedMesh {
+    uint64_t vertexOffset; // bytes desde o início do arquivo
+    uint64_t indexOffset;
+    uint64_t clusterOffset; // MeshCluster[clusterCount]
+    uint32_t vertexCount;  // em vértices (8 floats)
+    uint32_t indexCount;
+    uint32_t nameOffset, nameLength;
+    float localMin[3];
+    float localMax[3];
+    uint32_t flags;        // kCookedMesh*
+    int32_t node;          // nó que referencia o mesh (-1 = raiz do asset)
+    uint32_t indexSize;    // 2 ou 4 bytes
+    uint32_t lodCount;
+    uint32_t lodIndexCount[kMaxMeshLods]; // níveis em sequência no bloco de índices (soma = indexCount)
+    float lodError[kMaxMeshLods];
+    uint32_t clusterCount;
+};
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // o mapeamento continua válido sem o descritor
+    if (ptr == MAP_FAILED) return false;
+    data = (const unsigned char*)ptr;
+    size = (size_t)st.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) munmap((void*)data, size);
+    data = nullptr;
+    size = 0;
+}
+
+static std::string cookedPathFor(const std::string& filepath) {
+    size_t dot = filepath.find_last_of('.');
+    size_t slash = filepath.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return filepath + ".tjmesh";
+    return filepath.substr(0, dot) + ".tjmesh";
+}
+
+static bool fileStat(const std::string& path, uint64_t& size, int64_t& mtimeNs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = (uint64_t)st.st_size;
+    mtimeNs = (int64_t)st.st_mtim.tv_sec * 1000000000ll + st.st_mtim.tv_nsec;
+    return true;
+}
+
+static bool fileHash(const std::string& path, uint64_t& hash) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    hash = fnv1a64(file.data, file.size);
+    return true;
+}
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool dependencyIsCurrent(const CookedDependency& dep, const std::string& path) {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    if (!fileStat(path, size, mtimeNs) || size != dep.size) return false;
+    if (mtimeNs == dep.mtimeNs) return true;
+    // mtime mudou (checkout, cópia): só o conteúdo decide
+    uint64_t hash = 0;
+    return fileHash(path, hash) && hash == dep.hash;
+}
+
+bool GLTFRenderer::stageCookedModel(const std::string& filepath, StagedAsset& staged) const {
+    std::string cookedPath = cookedPathFor(filepath);
+    std::unique_ptr<MappedFile> mapping(new MappedFile());
+    if (!mapping->open(cookedPath)) return false;
+    const MappedFile& file = *mapping;
+
+    if (file.size < sizeof(CookedHeader)) return false;
+    const CookedHeader* header = (const CookedHeader*)file.data;
+    if (header->magic != kCookedMagic || header->version != kCookedVersion || header->fileSize != file.size ||
+        header->dependencyOffset + header->dependencyCount * sizeof(CookedDependency) > file.size ||
+        header->nodeOffset + header->nodeCount * sizeof(CookedNode) > file.size ||
+        header->clipOffset + header->clipCount * sizeof(CookedClip) > file.size ||
+        header->channelOffset + header->channelCount * sizeof(AnimationChannel) > file.size ||
+        header->timeOffset + (uint64_t)header->timeCount * sizeof(float) > file.size ||
+        header->valueOffset + (uint64_t)header->valueCount * sizeof(float) > file.size ||
+        header->meshOffset + header->meshCount * sizeof(CookedMesh) > file.size ||
+        header->stringOffset > file.size) {
+        std::cerr << "Arquivo cozido inválido ou de outra versão: '" << cookedPath << "'" << std::endl;
+        return false;
+    }
+    const char* strings = (const char*)file.data + header->stringOffset;
+    size_t stringBytes = file.size - header->stringOffset;
+
+    // Invalidação: qualquer arquivo de origem diferente do que foi cozido
+    const CookedDependency* deps = (const CookedDependency*)(file.data + header->dependencyOffset);
+    for (uint32_t i = 0; i < header->dependencyCount; ++i) {
+        if ((size_t)deps[i].pathOffset + deps[i].pathLength > stringBytes) return false;
+        std::string path(strings + deps[i].pathOffset, deps[i].pathLength);
+        if (!dependencyIsCurrent(deps[i], path)) {
+            std::cout << "Arquivo cozido desatualizado ('" << path << "' mudou): '" << cookedPath << "'" << std::endl;
+            return false;
+        }
+    }
+
+    const CookedNode* nodes = (const CookedNode*)(file.data + header->nodeOffset);
+    for (uint32_t i = 0; i < header->nodeCount; ++i) {
+        if (nodes[i].parent >= (int32_t)i || nodes[i].parent < -1 ||
+            (size_t)nodes[i].nameOffset + nodes[i].nameLength > stringBytes) {
+            std::cerr << "Nó " << i << " inválido em '" << cookedPath << "'" << std::endl;
+            return false;
+        }
+    }
+    const CookedClip* clips = (const CookedClip*)(file.data + header->clipOffset);
+    const AnimationChannel* channels = (const AnimationChannel*)(file.data + header->channelOffset);
+    for (uint32_t i = 0; i < header->clipCount; ++i) {
+        if ((uint64_t)clips[i].firstChannel + clips[i].channelCount > header->channelCount ||
+            (size_t)clips[i].nameOffset + clips[i].nameLength > stringBytes) {
+            std::cerr << "Clipe " << i << " inválido em '" << cookedPath << "'" << std::endl;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->channelCount; ++i) {
+        const AnimationChannel& c = channels[i];
+        uint64_t components = c.path == (uint8_t)AnimationPath::Rotation ? 4 : 3;
+        uint64_t perKey = c.interpolation == (uint8_t)AnimationInterpolation::CubicSpline ? 3 : 1;
+        if (c.node < 0 || c.node >= (int32_t)header->nodeCount || c.path > (uint8_t)AnimationPath::Scale ||
+            c.interpolation > (uint8_t)AnimationInterpolation::CubicSpline || c.keyCount == 0 ||
+            (uint64_t)c.firstKey + c.keyCount > header->timeCount ||
+            c.firstValue + c.keyCount * perKey * components > header->valueCount) {
+            std::cerr << "Canal de animação " << i << " inválido em '" << cookedPath << "'" << std::endl;
+            return false;
+        }
+    }
+    const CookedMesh* records = (const CookedMesh*)(file.data + header->meshOffset);
+    for (uint32_t i = 0; i < header->meshCount; ++i) {
+        const CookedMesh& r = records[i];
+        if (r.node < -1 || r.node >= (int32_t)header->nodeCount ||r.vertexOffset + (uint64_t)r.vertexCount * 8 * sizeof(float) > file.size ||
+            (r.indexSize != 2 && r.indexSize != 4) ||
+            r.indexOffset + (uint64_t)r.indexCount * r.indexSize > file.size ||
+            r.clusterOffset + (uint64_t)r.clusterCount * sizeof(MeshCluster) > file.size ||
+            (size_t)r.nameOffset + r.nameLength > stringBytes || r.lodCount < 1 || r.lodCount > kMaxMeshLods) {
+            std::cerr << "Mesh " << i << " fora dos limites em '" << cookedPath << "'" << std::endl;
+            return false;
+        }
+    }
+
+    // Tudo validado: os meshes apontam direto para o mapeamento (o upload lê dele, sem cópia)
+    staged.nodes.resize(header->nodeCount);
+    for (uint32_t i = 0; i < header->nodeCount; ++i) {
+        AssetNode& node = staged.nodes[i];
+        node.name.assign(strings + nodes[i].nameOffset, nodes[i].nameLength);
+        node.parent = nodes[i].parent;
+        std::memcpy(glm::value_ptr(node.local), nodes[i].local, sizeof(nodes[i].local));
+    }
+    // Animações são pequenas: copiadas (ficam depois que o mapeamento é liberado)
+    AnimationSet& animations = staged.animations;
+    animations.clips.resize(header->clipCount);
+    for (uint32_t i = 0; i < header->clipCount; ++i) {
+        AnimationClip& clip = animations.clips[i];
+        clip.name.assign(strings + clips[i].nameOffset, clips[i].nameLength);
+        clip.duration = clips[i].duration;
+        clip.firstChannel = clips[i].firstChannel;
+        clip.channelCount = clips[i].channelCount;
+    }
+    animations.channels.assign(channels, channels + header->channelCount);
+    const float* times = (const float*)(file.data + header->timeOffset);
+    const float* values = (const float*)(file.data + header->valueOffset);
+    animations.times.assign(times, times + header->timeCount);
+    animations.values.assign(values, values + header->valueCount);
+    staged.meshes.resize(header->meshCount);
+    for (uint32_t i = 0; i < header->meshCount; ++i) {
+        const CookedMesh& r = records[i];
+        StagedMesh& out = staged.meshes[i];
+        out.mesh.name.assign(strings + r.nameOffset, r.nameLength);
+        out.mesh.localMin = glm::vec3(r.localMin[0], r.localMin[1], r.localMin[2]);
+        out.mesh.localMax = glm::vec3(r.localMax[0], r.localMax[1], r.localMax[2]);
+        out.mesh.isDoor = (r.flags & kCookedMeshDoor) != 0;
+        out.mesh.doorHingeLeft = (r.flags & kCookedMeshHingeLeft) != 0;
+        out.mesh.doubleSided = (r.flags & kCookedMeshDoubleSided) != 0;
+        out.mesh.assetNode = r.node;
+        out.vertices = (const float*)(file.data + r.vertexOffset);
+        out.vertexCount = r.vertexCount;
+        out.indices = file.data + r.indexOffset;
+        out.indexCount = r.indexCount;
+        out.indexSize = r.indexSize;
+        uint32_t firstIndex = 0;
+        out.mesh.lodCount = (int)r.lodCount;
+        for (uint32_t l = 0; l < r.lodCount; ++l) {
+            out.mesh.lods[l].firstIndex = firstIndex;
+            out.mesh.lods[l].indexCount = std::min(r.lodIndexCount[l], r.indexCount - firstIndex);
+            out.mesh.lods[l].error = r.lodError[l];
+            firstIndex += out.mesh.lods[l].indexCount;
+        }
+        // Clusters são poucos: copiados para o mesh (ficam depois que o mapeamento é liberado)
+        const MeshCluster* clusters = (const MeshCluster*)(file.data + r.clusterOffset);
+        out.mesh.clusters.clear();
+        for (uint32_t c = 0; c < r.clusterCount; ++c) {
+            if ((uint64_t)clusters[c].firstIndex + clusters[c].indexCount > out.mesh.lods[0].indexCount) break;
+            out.mesh.clusters.push_back(clusters[c]);
+        }
+        if (out.mesh.clusters.size() != r.clusterCount) out.mesh.clusters.clear();
+    }
+    staged.mapping = std::move(mapping);
+    std::cout << "Asset cozido mapeado: '" << cookedPath << "' (" << header->meshCount << " meshes)" << std::endl;
+    return header->meshCount > 0;
+}
+
+bool GLTFRenderer::writeCookedModel(const std::string& filepath, const tinygltf::Model& gltfModel,
+                                    const std::vector<Mesh>& decoded, const std::vector<AssetNode>& nodes,
+                                    const AnimationSet& animations) const {
+    // Dependências: o próprio arquivo e os buffers externos (URIs data: já estão dentro dele)
+    std::vector<std::string> depPaths = { filepath };
+    size_t slash = filepath.find_last_of('/');
+    std::string baseDir = (slash == std::string::npos) ? "" : filepath.substr(0, slash + 1);
+    for (const auto& buffer : gltfModel.buffers) {
+        if (buffer.uri.empty() || buffer.uri.compare(0, 5, "data:") == 0) continue;
+        depPaths.push_back(baseDir + buffer.uri);
+    }
+
+    std::string strings;
+    std::vector<CookedDependency> deps;
+    for (const auto& path : depPaths) {
+        CookedDependency dep = {};
+        if (!fileStat(path, dep.size, dep.mtimeNs) || !fileHash(path, dep.hash)) {
+            std::cerr << "Não foi possível ler '" << path << "' para cozinhar" << std::endl;
+            return false;
+        }
+        dep.pathOffset = (uint32_t)strings.size();
+        dep.pathLength = (uint32_t)path.size();
+        strings += path;
+        deps.push_back(dep);
+    }
+
+    CookedHeader header = {};
+    header.magic = kCookedMagic;
+    header.version = kCookedVersion;
+    header.meshCount = (uint32_t)decoded.size();
+    header.dependencyCount = (uint32_t)deps.size();
+    header.nodeCount = (uint32_t)nodes.size();
+    header.clipCount = (uint32_t)animations.clips.size();
+    header.channelCount = (uint32_t)animations.channels.size();
+    header.timeCount = (uint32_t)animations.times.size();
+    header.valueCount = (uint32_t)animations.values.size();
+    header.dependencyOffset = sizeof(CookedHeader);
+    header.nodeOffset = header.dependencyOffset + deps.size() * sizeof(CookedDependency);
+    header.clipOffset = header.nodeOffset + nodes.size() * sizeof(CookedNode);
+    header.channelOffset = header.clipOffset + animations.clips.size() * sizeof(CookedClip);
+    header.meshOffset = header.channelOffset + animations.channels.size() * sizeof(AnimationChannel);
+    header.stringOffset = header.meshOffset + decoded.size() * sizeof(CookedMesh);
+
+    std::vector<CookedNode> nodeRecords(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        CookedNode& r = nodeRecords[i];
+        r = CookedNode();
+        r.parent = nodes[i].parent;
+        r.nameOffset = (uint32_t)strings.size();
+        r.nameLength = (uint32_t)nodes[i].name.size();
+        strings += nodes[i].name;
+        std::memcpy(r.local, glm::value_ptr(nodes[i].local), sizeof(r.local));
+    }
+    std::vector<CookedClip> clipRecords(animations.clips.size());
+    for (size_t i = 0; i < animations.clips.size(); ++i) {
+        const AnimationClip& clip = animations.clips[i];
+        CookedClip& r = clipRecords[i];
+        r.nameOffset = (uint32_t)strings.size();
+        r.nameLength = (uint32_t)clip.name.size();
+        strings += clip.name;
+        r.firstChannel = clip.firstChannel;
+        r.channelCount = clip.channelCount;
+        r.duration = clip.duration;
+    }
+    std::vector<CookedMesh> records(decoded.size());
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        const Mesh& mesh = decoded[i];
+        CookedMesh& r = records[i];
+        r = CookedMesh();
+        r.vertexCount = (uint32_t)(mesh.vertices.size() / 8);
+        r.indexCount = (uint32_t)mesh.indices.size();
+        r.indexSize = fitsShortIndices(r.vertexCount) ? 2 : 4;
+        r.lodCount = (uint32_t)std::max(mesh.lodCount, 1);
+        r.lodIndexCount[0] = mesh.lodCount > 1 ? mesh.lods[0].indexCount : r.indexCount;
+        for (int l = 1; l < mesh.lodCount; ++l) {
+            r.lodIndexCount[l] = mesh.lods[l].indexCount;
+            r.lodError[l] = mesh.lods[l].error;
+        }
+        r.nameOffset = (uint32_t)strings.size();
+        r.nameLength = (uint32_t)mesh.name.size();
+        strings += mesh.name;
+        for (int c = 0; c < 3; ++c) {
+            r.localMin[c] = mesh.localMin[c];
+            r.localMax[c] = mesh.localMax[c];
+        }
+        r.clusterCount = (uint32_t)mesh.clusters.size();
+        r.node = mesh.assetNode;
+        r.flags = (mesh.isDoor ? kCookedMeshDoor : 0u) | (mesh.doorHingeLeft ? kCookedMeshHingeLeft : 0u) |
+                  (mesh.doubleSided ? kCookedMeshDoubleSided : 0u);
+    }
+    size_t cursor = header.stringOffset + strings.size();
+    header.timeOffset = alignUp(cursor, kCookedBlobAlignment);
+    cursor = header.timeOffset + animations.times.size() * sizeof(float);
+    header.valueOffset = alignUp(cursor, kCookedBlobAlignment);
+    cursor = header.valueOffset + animations.values.size() * sizeof(float);
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        records[i].vertexOffset = alignUp(cursor, kCookedBlobAlignment);
+        cursor = records[i].vertexOffset + decoded[i].vertices.size() * sizeof(float);
+        records[i].indexOffset = alignUp(cursor, kCookedBlobAlignment);
+        cursor = records[i].indexOffset + decoded[i].indices.size() * records[i].indexSize;
+        records[i].clusterOffset = alignUp(cursor, kCookedBlobAlignment);
+        cursor = records[i].clusterOffset + decoded[i].clusters.size() * sizeof(MeshCluster);
+    }
+    header.fileSize = cursor;
+
+    // Gravar em um temporário e renomear: uma execução concorrente nunca vê o arquivo pela metade
+    std::string cookedPath = cookedPathFor(filepath);
+    std::string tmpPath = cookedPath + ".tmp";
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Não foi possível gravar '" << tmpPath << "'" << std::endl;
+        return false;
+    }
+    static const char zeros[kCookedBlobAlignment] = {};
+    auto pad = [&](size_t offset) {
+        size_t at = (size_t)file.tellp();
+        if (offset > at) file.write(zeros, offset - at);
+    };
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)deps.data(), deps.size() * sizeof(CookedDependency));
+    file.write((const char*)nodeRecords.data(), nodeRecords.size() * sizeof(CookedNode));
+    file.write((const char*)clipRecords.data(), clipRecords.size() * sizeof(CookedClip));
+    file.write((const char*)animations.channels.data(), animations.channels.size() * sizeof(AnimationChannel));
+    file.write((const char*)records.data(), records.size() * sizeof(CookedMesh));
+    file.write(strings.data(), strings.size());
+    pad(header.timeOffset);
+    file.write((const char*)animations.times.data(), animations.times.size() * sizeof(float));
+    pad(header.valueOffset);
+    file.write((const char*)animations.values.data(), animations.values.size() * sizeof(float));
+    for (size_t i = 0; i < decoded.size(); ++i) {
+        pad(records[i].vertexOffset);
+        file.write((const char*)decoded[i].vertices.data(), decoded[i].vertices.size() * sizeof(float));
+        pad(records[i].indexOffset);
+        if (records[i].indexSize == 2) {
+            std::vector<uint16_t> narrow(decoded[i].indices.size());
+            narrowIndices(decoded[i].indices.data(), narrow.size(), narrow.data());
+            file.write((const char*)narrow.data(), narrow.size() * sizeof(uint16_t));
+        } else {
+            file.write((const char*)decoded[i].indices.data(), decoded[i].indices.size() * sizeof(unsigned int));
+        }
+        pad(records[i].clusterOffset);
+        file.write((const char*)decoded[i].clusters.data(), decoded[i].clusters.size() * sizeof(MeshCluster));
+    }
+    file.close();
+    if (!file || std::rename(tmpPath.c_str(), cookedPath.c_str()) != 0) {
+        std::cerr << "Falha ao gravar '" << cookedPath << "'" << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    std::cout << "Asset cozido: '" << cookedPath << "' (" << decoded.size() << " meshes, "
+              << header.fileSize / 1024 << " KB)" << std::endl;
+    return true;
+}
+
+bool GLTFRenderer::cookModel(const std::string& filepath) {
+    // Só CPU: parse + decode + gravação, sem tocar na arena
+    tinygltf::Model gltfModel;
+    GLTFSource source;
+    if (!parseGLTFFile(filepath, gltfModel, source)) return false;
+    std::vector<Mesh> decoded;
+    std::vector<AssetNode> nodes;
+    AnimationSet animations;
+    decodeModel(gltfModel, source, decoded, nodes, animations);
+    if (decoded.empty()) {
+        std::cerr << "Nenhum mesh para cozinhar em '" << filepath << "'" << std::endl;
+        return false;
+    }
+    return writeCookedModel(filepath, gltfModel, decoded, nodes, animations);
+}
@@ -0,0 +1,618 @@
+#include "MeshOptimize.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+static const size_t kVertexFloats = 8;
+static const unsigned kNoVertex = ~0u;
+
+static uint64_t hashVertex(const float* v) {
+    // Mistura das 8 palavras (bits exatos: -0 e +0, NaNs diferentes continuam distintos)
+    uint32_t words[kVertexFloats];
+    std::memcpy(words, v, sizeof(words));
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (uint32_t w : words) {
+        h ^= w;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+// Solda vértices idênticos bit a bit (costuras de UV/normal que o exportador repetiu sem necessidade)
+static void weldVertices(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    size_t vertexCount = vertices.size() / kVertexFloats;
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) tableSize <<= 1;
+    std::vector<unsigned> table(tableSize, kNoVertex); // endereçamento aberto, sondagem linear
+    std::vector<unsigned> remap(vertexCount);
+    size_t unique = 0;
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* src = &vertices[v * kVertexFloats];
+        size_t slot = (size_t)hashVertex(src) & (tableSize - 1);
+        for (;;) {
+            unsigned existing = table[slot];
+            if (existing == kNoVertex) {
+                table[slot] = (unsigned)unique;
+                if (unique != v) std::memmove(&vertices[unique * kVertexFloats], src, kVertexFloats * sizeof(float));
+                remap[v] = (unsigned)unique++;
+                break;
+            }
+            if (std::memcmp(&vertices[existing * kVertexFloats], src, kVertexFloats * sizeof(float)) == 0) {
+                remap[v] = existing;
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+    }
+    vertices.resize(unique * kVertexFloats);
+    for (auto& index : indices) index = remap[index];
+}
+
+// Tipsify (Sander, Nehab, Barczak 2007): leque em torno de um vértice "foco" escolhido entre os que
+// acabaram de entrar no cache; tempo linear, sem tabela de pontuação
+static void tipsifyTriangles(std::vector<unsigned int>& indices, size_t vertexCount, unsigned cacheSize) {
+    size_t triangleCount = indices.size() / 3;
+    // Adjacência vértice → triângulos (CSR)
+    std::vector<unsigned> live(vertexCount, 0), offsets(vertexCount + 1, 0), adjacency(indices.size());
+    for (unsigned index : indices) live[index]++;
+    for (size_t v = 0; v < vertexCount; ++v) offsets[v + 1] = offsets[v] + live[v];
+    std::vector<unsigned> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = (unsigned)t;
+    }
+
+    std::vector<unsigned> cacheTime(vertexCount, 0);
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<unsigned> deadEnd, candidates, output;
+    output.reserve(indices.size());
+    unsigned timestamp = cacheSize + 1;
+    size_t cursor = 0; // próximo vértice a tentar quando a pilha de becos sem saída esvazia
+
+    auto skipDeadEnd = [&]() -> unsigned {
+        while (!deadEnd.empty()) {
+            unsigned d = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[d] > 0) return d;
+        }
+        for (; cursor < vertexCount; ++cursor) {
+            if (live[cursor] > 0) return (unsigned)cursor;
+        }
+        return kNoVertex;
+    };
+
+    unsigned fanning = skipDeadEnd();
+    while (fanning != kNoVertex) {
+        candidates.clear();
+        for (unsigned a = offsets[fanning]; a < offsets[fanning + 1]; ++a) {
+            unsigned t = adjacency[a];
+            if (emitted[t]) continue;
+            for (int k = 0; k < 3; ++k) {
+                unsigned v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (timestamp - cacheTime[v] > cacheSize) cacheTime[v] = timestamp++;
+            }
+            emitted[t] = 1;
+        }
+        // Próximo foco: o candidato ainda no cache que continuará nele depois do seu leque, o mais antigo
+        unsigned best = kNoVertex;
+        int bestPriority = -1;
+        for (unsigned v : candidates) {
+            if (live[v] == 0) continue;
+            int priority = 0;
+            if (timestamp - cacheTime[v] + 2 * live[v] <= cacheSize) priority = (int)(timestamp - cacheTime[v]);
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+        fanning = best != kNoVertex ? best : skipDeadEnd();
+    }
+    indices.swap(output);
+}
+
+// Vértices na ordem da primeira referência; vértices não referenciados saem
+static void reorderVerticesForFetch(std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    size_t vertexCount = vertices.size() / kVertexFloats;
+    std::vector<unsigned> remap(vertexCount, kNoVertex);
+    std::vector<float> reordered;
+    reordered.reserve(vertices.size());
+    unsigned next = 0;
+    for (auto& index : indices) {
+        if (remap[index] == kNoVertex) {
+            remap[index] = next++;
+            reordered.insert(reordered.end(), &vertices[index * kVertexFloats], &vertices[index * kVertexFloats] + kVertexFloats);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+float vertexCacheACMR(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize) {
+    if (indexCount < 3) return 0.0f;
+    // FIFO: cada vértice guarda o instante de entrada; está no cache se entrou há menos de cacheSize misses
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t misses = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        size_t& at = insertedAt[indices[i]];
+        if (at == 0 || misses + 1 - at > cacheSize) at = ++misses;
+    }
+    return (float)misses / (float)(indexCount / 3);
+}
+
+bool optimizeMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, MeshOptimizeStats& stats) {
+    size_t vertexCount = vertices.size() / kVertexFloats;
+    stats.verticesBefore = stats.verticesAfter = vertexCount;
+    if (indices.empty() || indices.size() % 3 != 0) return false;
+    for (unsigned index : indices) {
+        if (index >= vertexCount) return false; // índices inválidos: deixa como veio
+    }
+    stats.acmrBefore = stats.acmrAfter = vertexCacheACMR(indices.data(), indices.size(), vertexCount);
+
+    weldVertices(vertices, indices);
+    tipsifyTriangles(indices, vertices.size() / kVertexFloats, kVertexCacheSize);
+    reorderVerticesForFetch(vertices, indices);
+
+    stats.verticesAfter = vertices.size() / kVertexFloats;
+    stats.acmrAfter = vertexCacheACMR(indices.data(), indices.size(), stats.verticesAfter);
+    return true;
+}
+
+void narrowIndices(const unsigned int* indices, size_t indexCount, uint16_t* out) {
+    for (size_t i = 0; i < indexCount; ++i) out[i] = (uint16_t)indices[i];
+}
+
+// ---- Níveis de detalhe (QEM) ----
+
+// Malhas pequenas demais não ganham nada com LOD
+static const size_t kLodMinTriangles = 64;
+// Fração de triângulos de cada nível em relação ao anterior
+static const float kLodReduction = 0.5f;
+// Um nível só vale se reduzir pelo menos isto em relação ao anterior
+static const float kLodMinGain = 0.85f;
+// Erro máximo aceito em um colapso, relativo à diagonal do mesh
+static const float kLodMaxRelativeError = 0.05f;
+// Peso dos planos de borda (mantém o contorno de malhas abertas: vãos de janela, recortes)
+static const double kLodBorderWeight = 10.0;
+
+// Quádrica simétrica 4x4 (10 coeficientes) + peso acumulado (área) para normalizar o erro
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0, a11 = 0, a12 = 0, a13 = 0, a22 = 0, a23 = 0, a33 = 0;
+    double weight = 0;
+
+    void addPlane(double nx, double ny, double nz, double d, double w) {
+        a00 += w * nx * nx; a01 += w * nx * ny; a02 += w * nx * nz; a03 += w * nx * d;
+        a11 += w * ny * ny; a12 += w * ny * nz; a13 += w * ny * d;
+        a22 += w * nz * nz; a23 += w * nz * d;
+        a33 += w * d * d;
+        weight += w;
+    }
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03; a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23; a33 += q.a33; weight += q.weight;
+    }
+    // Distância² média (ponderada) da posição aos planos acumulados
+    double error(const float* p) const {
+        double x = p[0], y = p[1], z = p[2];
+        double e = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                   a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+                   a22 * z * z + 2 * a23 * z + a33;
+        return weight > 0 ? std::max(e, 0.0) / weight : 0.0;
+    }
+};
+
+struct Collapse {
+    double cost;
+    unsigned from, to;
+    unsigned fromVersion, toVersion;
+    bool operator<(const Collapse& o) const { return cost > o.cost; } // heap de mínimo
+};
+
+static void cross3(const float* a, const float* b, const float* c, float* n) {
+    float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+int buildMeshLods(const std::vector<float>& vertices, std::vector<unsigned int>& indices, MeshLOD* lods) {
+    size_t vertexCount = vertices.size() / kVertexFloats;
+    size_t baseIndexCount = indices.size();
+    lods[0] = MeshLOD();
+    lods[0].indexCount = (uint32_t)baseIndexCount;
+    size_t triangleCount = baseIndexCount / 3;
+    if (triangleCount < kLodMinTriangles || baseIndexCount % 3 != 0) return 1;
+
+    // Vértices agrupados por posição (costuras viram um único nó da simplificação)
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2) tableSize <<= 1;
+    std::vector<unsigned> table(tableSize, kNoVertex), nodeOf(vertexCount);
+    std::vector<unsigned> nodeVertex; // um vértice representante por nó (fornece a posição)
+    for (size_t v = 0; v < vertexCount; ++v) {
+        const float* p = &vertices[v * kVertexFloats];
+        uint32_t words[3];
+        std::memcpy(words, p, sizeof(words));
+        uint64_t h = ((uint64_t)words[0] * 0x9E3779B97F4A7C15ull) ^ ((uint64_t)words[1] * 0xC2B2AE3D27D4EB4Full) ^
+                     ((uint64_t)words[2] * 0x165667B19E3779F9ull);
+        size_t slot = (size_t)(h ^ (h >> 29)) & (tableSize - 1);
+        for (;;) {
+            unsigned node = table[slot];
+            if (node == kNoVertex) {
+                table[slot] = (unsigned)nodeVertex.size();
+                nodeOf[v] = (unsigned)nodeVertex.size();
+                nodeVertex.push_back((unsigned)v);
+                break;
+            }
+            if (std::memcmp(&vertices[nodeVertex[node] * kVertexFloats], p, 3 * sizeof(float)) == 0) {
+                nodeOf[v] = node;
+                break;
+            }
+            slot = (slot + 1) & (tableSize - 1);
+        }
+    }
+    size_t nodeCount = nodeVertex.size();
+    auto position = [&](unsigned node) { return &vertices[nodeVertex[node] * kVertexFloats]; };
+
+    // Vértices de cada nó (CSR), usados para escolher o vértice de saída depois de um colapso
+    std::vector<unsigned> nodeStart(nodeCount + 1, 0), nodeList(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v) nodeStart[nodeOf[v] + 1]++;
+    for (size_t n = 0; n < nodeCount; ++n) nodeStart[n + 1] += nodeStart[n];
+    {
+        std::vector<unsigned> fill(nodeStart.begin(), nodeStart.end() - 1);
+        for (size_t v = 0; v < vertexCount; ++v) nodeList[fill[nodeOf[v]]++] = (unsigned)v;
+    }
+
+    // Triângulos em espaço de nós (degenerados por posição ficam de fora) + adjacência nó → triângulos
+    std::vector<unsigned> tri(baseIndexCount);
+    std::vector<char> removed(triangleCount, 0);
+    std::vector<std::vector<unsigned>> nodeTriangles(nodeCount);
+    size_t liveTriangles = 0;
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) tri[t * 3 + k] = nodeOf[indices[t * 3 + k]];
+        if (tri[t * 3] == tri[t * 3 + 1] || tri[t * 3 + 1] == tri[t * 3 + 2] || tri[t * 3] == tri[t * 3 + 2]) {
+            removed[t] = 1;
+            continue;
+        }
+        liveTriangles++;
+        for (int k = 0; k < 3; ++k) nodeTriangles[tri[t * 3 + k]].push_back((unsigned)t);
+    }
+    if (liveTriangles < kLodMinTriangles) return 1;
+
+    // Quádricas: plano de cada triângulo ponderado pela área; arestas de borda ganham um plano perpendicular
+    std::vector<Quadric> quadrics(nodeCount);
+    std::unordered_map<uint64_t, int> edgeUse;
+    edgeUse.reserve(liveTriangles * 3);
+    auto edgeKey = [](unsigned a, unsigned b) { return a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a; };
+    float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (size_t n = 0; n < nodeCount; ++n) {
+        for (int c = 0; c < 3; ++c) {
+            boundsMin[c] = std::min(boundsMin[c], position((unsigned)n)[c]);
+            boundsMax[c] = std::max(boundsMax[c], position((unsigned)n)[c]);
+        }
+    }
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (removed[t]) continue;
+        const float* p0 = position(tri[t * 3]);
+        float n[3];
+        cross3(p0, position(tri[t * 3 + 1]), position(tri[t * 3 + 2]), n);
+        double length = std::sqrt((double)n[0] * n[0] + (double)n[1] * n[1] + (double)n[2] * n[2]);
+        if (length > 0) {
+            double nx = n[0] / length, ny = n[1] / length, nz = n[2] / length;
+            double d = -(nx * p0[0] + ny * p0[1] + nz * p0[2]);
+            for (int k = 0; k < 3; ++k) quadrics[tri[t * 3 + k]].addPlane(nx, ny, nz, d, length * 0.5);
+        }
+        for (int k = 0; k < 3; ++k) edgeUse[edgeKey(tri[t * 3 + k], tri[t * 3 + (k + 1) % 3])]++;
+    }
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (removed[t]) continue;
+        float n[3];
+        cross3(position(tri[t * 3]), position(tri[t * 3 + 1]), position(tri[t * 3 + 2]), n);
+        for (int k = 0; k < 3; ++k) {
+            unsigned a = tri[t * 3 + k], b = tri[t * 3 + (k + 1) % 3];
+            if (edgeUse[edgeKey(a, b)] != 1) continue;
+            const float* pa = position(a);
+            const float* pb = position(b);
+            double e[3] = { (double)pb[0] - pa[0], (double)pb[1] - pa[1], (double)pb[2] - pa[2] };
+            // Plano que contém a aresta e é perpendicular à face
+            double px = e[1] * n[2] - e[2] * n[1], py = e[2] * n[0] - e[0] * n[2], pz = e[0] * n[1] - e[1] * n[0];
+            double length = std::sqrt(px * px + py * py + pz * pz);
+            if (length <= 0) continue;
+            px /= length; py /= length; pz /= length;
+            double d = -(px * pa[0] + py * pa[1] + pz * pa[2]);
+            double edgeLength = std::sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+            quadrics[a].addPlane(px, py, pz, d, kLodBorderWeight * edgeLength * edgeLength);
+            quadrics[b].addPlane(px, py, pz, d, kLodBorderWeight * edgeLength * edgeLength);
+        }
+    }
+
+    double diagonal = std::sqrt((double)(boundsMax[0] - boundsMin[0]) * (boundsMax[0] - boundsMin[0]) +
+                                (double)(boundsMax[1] - boundsMin[1]) * (boundsMax[1] - boundsMin[1]) +
+                                (double)(boundsMax[2] - boundsMin[2]) * (boundsMax[2] - boundsMin[2]));
+    double maxCost = (kLodMaxRelativeError * diagonal) * (kLodMaxRelativeError * diagonal);
+
+    std::vector<unsigned> version(nodeCount, 0);
+    std::vector<char> alive(nodeCount, 1);
+    std::vector<Collapse> heap;
+    auto pushCollapse = [&](unsigned from, unsigned to) {
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+        heap.push_back({ q.error(position(to)), from, to, version[from], version[to] });
+        std::push_heap(heap.begin(), heap.end());
+    };
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (removed[t]) continue;
+        for (int k = 0; k < 3; ++k) {
+            unsigned a = tri[t * 3 + k], b = tri[t * 3 + (k + 1) % 3];
+            pushCollapse(a, b);
+            pushCollapse(b, a);
+        }
+    }
+
+    // O colapso não pode virar nenhum triângulo restante em volta de from
+    auto collapseFlips = [&](unsigned from, unsigned to) {
+        for (unsigned t : nodeTriangles[from]) {
+            if (removed[t]) continue;
+            unsigned* c = &tri[t * 3];
+            if (c[0] == to || c[1] == to || c[2] == to) continue;
+            const float* p[3] = { position(c[0]), position(c[1]), position(c[2]) };
+            float before[3], after[3];
+            cross3(p[0], p[1], p[2], before);
+            for (int k = 0; k < 3; ++k) {
+                if (c[k] == from) p[k] = position(to);
+            }
+            cross3(p[0], p[1], p[2], after);
+            if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f) return true;
+        }
+        return false;
+    };
+
+    // Saída de um nível: cada canto usa, no nó final, o vértice de atributos mais parecidos com o original
+    auto emitLevel = [&](std::vector<unsigned>& out) {
+        out.clear();
+        for (size_t t = 0; t < triangleCount; ++t) {
+            if (removed[t]) continue;
+            for (int k = 0; k < 3; ++k) {
+                unsigned original = indices[t * 3 + k];
+                unsigned node = tri[t * 3 + k];
+                if (nodeOf[original] == node) {
+                    out.push_back(original);
+                    continue;
+                }
+                const float* a = &vertices[original * kVertexFloats];
+                unsigned best = nodeVertex[node];
+                float bestDistance = FLT_MAX;
+                for (unsigned i = nodeStart[node]; i < nodeStart[node + 1]; ++i) {
+                    const float* b = &vertices[nodeList[i] * kVertexFloats];
+                    float distance = 0.0f;
+                    for (int c = 3; c < 8; ++c) distance += (a[c] - b[c]) * (a[c] - b[c]);
+                    if (distance < bestDistance) {
+                        bestDistance = distance;
+                        best = nodeList[i];
+                    }
+                }
+                out.push_back(best);
+            }
+        }
+    };
+
+    int levels = 1;
+    size_t previousTriangles = liveTriangles;
+    size_t target = (size_t)(liveTriangles * kLodReduction);
+    double levelCost = 0.0;
+    std::vector<unsigned> levelIndices;
+    while (levels < kMaxMeshLods) {
+        bool exhausted = true;
+        while (!heap.empty()) {
+            if (liveTriangles <= target) {
+                exhausted = false;
+                break;
+            }
+            std::pop_heap(heap.begin(), heap.end());
+            Collapse c = heap.back();
+            heap.pop_back();
+            if (!alive[c.from] || !alive[c.to] || version[c.from] != c.fromVersion || version[c.to] != c.toVersion) continue;
+            if (c.cost > maxCost) {
+                heap.clear();
+                break;
+            }
+            if (collapseFlips(c.from, c.to)) continue;
+
+            // from → to: triângulos com os dois somem, os demais passam a usar to
+            alive[c.from] = 0;
+            quadrics[c.to].add(quadrics[c.from]);
+            version[c.to]++;
+            levelCost = std::max(levelCost, c.cost);
+            for (unsigned t : nodeTriangles[c.from]) {
+                if (removed[t]) continue;
+                unsigned* corners = &tri[t * 3];
+                if (corners[0] == c.to || corners[1] == c.to || corners[2] == c.to) {
+                    removed[t] = 1;
+                    liveTriangles--;
+                    continue;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    if (corners[k] == c.from) corners[k] = c.to;
+                }
+                nodeTriangles[c.to].push_back(t);
+            }
+            std::vector<unsigned>().swap(nodeTriangles[c.from]);
+            // Custos em volta de to mudaram (quádrica somada)
+            auto& around = nodeTriangles[c.to];
+            around.erase(std::remove_if(around.begin(), around.end(), [&](unsigned t) { return removed[t] != 0; }),
+                         around.end());
+            for (unsigned t : around) {
+                for (int k = 0; k < 3; ++k) {
+                    unsigned other = tri[t * 3 + k];
+                    if (other == c.to) continue;
+                    pushCollapse(c.to, other);
+                    pushCollapse(other, c.to);
+                }
+            }
+        }
+        if (liveTriangles == 0 || liveTriangles > previousTriangles * kLodMinGain) break;
+
+        emitLevel(levelIndices);
+        tipsifyTriangles(levelIndices, vertexCount, kVertexCacheSize);
+        MeshLOD& lod = lods[levels++];
+        lod.firstIndex = (uint32_t)indices.size();
+        lod.indexCount = (uint32_t)levelIndices.size();
+        lod.error = (float)std::sqrt(levelCost);
+        indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+        previousTriangles = liveTriangles;
+        target = (size_t)(liveTriangles * kLodReduction);
+        if (exhausted) break;
+    }
+    return levels;
+}
+
+// Peso da distância ao centro do cluster na escolha do próximo triângulo (relativo ao raio atual)
+static const float kClusterDistanceWeight = 0.5f;
+
+void buildMeshClusters(const std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t indexCount,
+                       std::vector<MeshCluster>& clusters) {
+    clusters.clear();
+    size_t triangleCount = indexCount / 3;
+    size_t vertexCount = vertices.size() / kVertexFloats;
+    if (triangleCount < kClusterMinMeshTriangles || indexCount % 3 != 0 || indexCount > indices.size()) return;
+
+    // Normais de face (unitárias; área em separado) e centróides
+    std::vector<float> faceNormal(triangleCount * 3), faceArea(triangleCount), centroid(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        const float* p[3];
+        for (int k = 0; k < 3; ++k) p[k] = &vertices[indices[t * 3 + k] * kVertexFloats];
+        float n[3];
+        cross3(p[0], p[1], p[2], n);
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        faceArea[t] = length * 0.5f;
+        for (int c = 0; c < 3; ++c) {
+            faceNormal[t * 3 + c] = length > 0.0f ? n[c] / length : 0.0f;
+            centroid[t * 3 + c] = (p[0][c] + p[1][c] + p[2][c]) * (1.0f / 3.0f);
+        }
+    }
+
+    // Triângulos por vértice (CSR) para crescer os clusters pela vizinhança
+    std::vector<unsigned> firstTriangle(vertexCount + 1, 0), vertexTriangles(indexCount);
+    for (size_t i = 0; i < indexCount; ++i) firstTriangle[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v) firstTriangle[v + 1] += firstTriangle[v];
+    {
+        std::vector<unsigned> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < indexCount; ++i) vertexTriangles[fill[indices[i]]++] = (unsigned)(i / 3);
+    }
+
+    std::vector<unsigned char> assigned(triangleCount, 0);
+    std::vector<unsigned> candidateStamp(triangleCount, kNoVertex);
+    std::vector<unsigned> order, members, candidates;
+    order.reserve(triangleCount);
+    size_t seedCursor = 0; // a ordem do cache (Tipsify) já é espacialmente coerente: sementes em sequência
+
+    while (order.size() < triangleCount) {
+        unsigned clusterId = (unsigned)clusters.size();
+        members.clear();
+        candidates.clear();
+        float normalSum[3] = { 0, 0, 0 }, centerSum[3] = { 0, 0, 0 };
+        float boxMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, boxMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        auto addTriangle = [&](unsigned t) {
+            assigned[t] = 1;
+            members.push_back(t);
+            for (int c = 0; c < 3; ++c) {
+                normalSum[c] += faceNormal[t * 3 + c] * faceArea[t];
+                centerSum[c] += centroid[t * 3 + c];
+            }
+            for (int k = 0; k < 3; ++k) {
+                unsigned v = indices[t * 3 + k];
+                const float* p = &vertices[v * kVertexFloats];
+                for (int c = 0; c < 3; ++c) {
+                    boxMin[c] = std::min(boxMin[c], p[c]);
+                    boxMax[c] = std::max(boxMax[c], p[c]);
+                }
+                for (unsigned j = firstTriangle[v]; j < firstTriangle[v + 1]; ++j) {
+                    unsigned n = vertexTriangles[j];
+                    if (assigned[n] || candidateStamp[n] == clusterId) continue;
+                    candidateStamp[n] = clusterId;
+                    candidates.push_back(n);
+                }
+            }
+        };
+
+        while (members.size() < kClusterMaxTriangles) {
+            // Melhor vizinho: normal próxima da média e centróide perto do centro atual
+            int best = -1;
+            float bestScore = -FLT_MAX;
+            if (!members.empty()) {
+                float axis[3] = { normalSum[0], normalSum[1], normalSum[2] };
+                float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+                float inv = axisLength > 0.0f ? 1.0f / axisLength : 0.0f;
+                float center[3], radius = 0.0f;
+                for (int c = 0; c < 3; ++c) {
+                    center[c] = centerSum[c] / (float)members.size();
+                    radius += (boxMax[c] - boxMin[c]) * (boxMax[c] - boxMin[c]);
+                }
+                radius = std::max(std::sqrt(radius) * 0.5f, 1e-6f);
+                for (size_t k = 0; k < candidates.size(); ++k) {
+                    unsigned t = candidates[k];
+                    if (assigned[t]) continue;
+                    float alignment = (faceNormal[t * 3] * axis[0] + faceNormal[t * 3 + 1] * axis[1] +
+                                       faceNormal[t * 3 + 2] * axis[2]) * inv;
+                    float d[3] = { centroid[t * 3] - center[0], centroid[t * 3 + 1] - center[1],
+                                   centroid[t * 3 + 2] - center[2] };
+                    float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                    float score = alignment - kClusterDistanceWeight * distance / radius;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = (int)k;
+                    }
+                }
+            }
+            unsigned next;
+            if (best >= 0) {
+                next = candidates[best];
+                candidates[best] = candidates.back();
+                candidates.pop_back();
+            } else {
+                // Sem vizinhos (início ou ilha esgotada): próximo triângulo livre na ordem atual
+                while (seedCursor < triangleCount && assigned[seedCursor]) ++seedCursor;
+                if (seedCursor == triangleCount) break;
+                next = (unsigned)seedCursor;
+            }
+            addTriangle(next);
+        }
+
+        // Triângulos do cluster na ordem original (mantém a ordem do cache dentro do cluster)
+        std::sort(members.begin(), members.end());
+        MeshCluster cluster;
+        cluster.firstIndex = (uint32_t)(order.size() * 3);
+        cluster.indexCount = (uint32_t)(members.size() * 3);
+        for (int c = 0; c < 3; ++c) {
+            cluster.boundsMin[c] = boxMin[c];
+            cluster.boundsMax[c] = boxMax[c];
+        }
+        float axisLength = std::sqrt(normalSum[0] * normalSum[0] + normalSum[1] * normalSum[1] + normalSum[2] * normalSum[2]);
+        if (axisLength > 0.0f) {
+            for (int c = 0; c < 3; ++c) cluster.coneAxis[c] = normalSum[c] / axisLength;
+            // Menor cosseno entre o eixo e as normais das faces; >= 90° não permite descartar nada
+            float minDot = 1.0f;
+            for (unsigned t : members) {
+                if (faceArea[t] <= 0.0f) continue;
+                float dot = faceNormal[t * 3] * cluster.coneAxis[0] + faceNormal[t * 3 + 1] * cluster.coneAxis[1] +
+                            faceNormal[t * 3 + 2] * cluster.coneAxis[2];
+                minDot = std::min(minDot, dot);
+            }
+            if (minDot > 0.0f) cluster.coneCutoff = std::sqrt(std::max(1.0f - minDot * minDot, 0.0f));
+        }
+        clusters.push_back(cluster);
+        order.insert(order.end(), members.begin(), members.end());
+    }
+
+    std::vector<unsigned int> reordered(indexCount);
+    for (size_t i = 0; i < triangleCount; ++i) {
+        for (int k = 0; k < 3; ++k) reordered[i * 3 + k] = indices[order[i] * 3 + k];
+    }
+    std::copy(reordered.begin(), reordered.end(), indices.begin());
+}
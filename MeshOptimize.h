@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Otimização de malha no carregamento (só CPU; o resultado vai para o arquivo cozido):
+// solda de vértices idênticos bit a bit, ordem dos triângulos para o cache pós-transformação (Tipsify),
+// ordem dos vértices pela primeira referência (localidade de busca). Vértices intercalados [pos3 normal3 uv2]
+
+// Tamanho de cache FIFO assumido na ordenação e na medida do ACMR
+const unsigned kVertexCacheSize = 16;
+
+struct MeshOptimizeStats {
+    size_t verticesBefore = 0, verticesAfter = 0;
+    float acmrBefore = 0.0f, acmrAfter = 0.0f; // misses do cache por triângulo
+};
+
+// Lista de triângulos otimizada no lugar; false (nada muda) se indices não for uma lista de triângulos válida
+// sobre os vértices: nesse caso LODs e clusters também não devem ser gerados
+bool optimizeMesh(std::vector<float>& vertices, std::vector<unsigned int>& indices, MeshOptimizeStats& stats);
+
+// Average Cache Miss Ratio de uma lista de triângulos em um cache FIFO de cacheSize vértices
+float vertexCacheACMR(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+                      unsigned cacheSize = kVertexCacheSize);
+
+// Níveis de detalhe: faixas de índices sobre os mesmos vértices, guardadas em sequência no bloco de índices
+// do mesh (nível 0 = malha original). error = desvio geométrico estimado, na unidade do asset
+struct MeshLOD {
+    uint32_t firstIndex = 0; // relativo ao início dos índices do mesh
+    uint32_t indexCount = 0;
+    float error = 0.0f;
+};
+const int kMaxMeshLods = 4;
+
+// Simplificação por erro quádrico (Garland-Heckbert, colapso de aresta para um vértice existente):
+// gera até kMaxMeshLods - 1 níveis com ~1/2, 1/4 e 1/8 dos triângulos e os anexa a indices.
+// Costuras de UV/normal não abrem (o colapso é feito por posição). Retorna o número de níveis (>= 1)
+int buildMeshLods(const std::vector<float>& vertices, std::vector<unsigned int>& indices, MeshLOD* lods);
+
+// Clusters (meshlets) do nível completo: faixas contíguas de até kClusterMaxTriangles triângulos vizinhos, com
+// AABB e cone de normais no espaço do asset, para culling por frustum e por face traseira dentro de meshes grandes
+const unsigned kClusterMaxTriangles = 128;
+const unsigned kClusterMinMeshTriangles = 1024; // abaixo disso o mesh é testado só inteiro
+struct MeshCluster {
+    uint32_t firstIndex = 0; // relativo ao início dos índices do mesh (dentro de lods[0])
+    uint32_t indexCount = 0;
+    float boundsMin[3] = { 0, 0, 0 }, boundsMax[3] = { 0, 0, 0 };
+    float coneAxis[3] = { 0, 0, 0 };
+    // Seno do ângulo do cone de normais: o cluster inteiro está de costas quando
+    // dot(centro - câmera, eixo) >= coneCutoff * |centro - câmera| + raio. > 1 = nunca (cone aberto demais)
+    float coneCutoff = 2.0f;
+};
+
+// Reordena os triângulos de indices[0, indexCount) em clusters crescidos por vizinhança (normal parecida, perto
+// do centro) e preenche clusters; nada muda em meshes com menos de kClusterMinMeshTriangles triângulos
+void buildMeshClusters(const std::vector<float>& vertices, std::vector<unsigned int>& indices, size_t indexCount,
+                       std::vector<MeshCluster>& clusters);
+
+// Índices de 16 bits bastam (o 0xFFFF fica livre, como no restart primitivo)
+inline bool fitsShortIndices(size_t vertexCount) { return vertexCount < 65536; }
+void narrowIndices(const unsigned int* indices, size_t indexCount, uint16_t* out);
@@ -0,0 +1,136 @@
+#include "GLTFRenderer.h"
+
+// Deslocamento da câmera (por frame) acima do qual os resultados antigos não são confiáveis
+static const float kOcclusionMaxStep = 0.25f;
+// Folga da caixa testada: fica à frente da própria superfície (evita auto-oclusão)
+// e cobre a câmera próxima/dentro da caixa
+static const float kOcclusionPadding = 0.05f;
+static const float kOcclusionNearMargin = 0.1f;
+// Consulta sem resposta após este número de frames: volta a desenhar
+static const unsigned kOcclusionMaxLatency = 2;
+
+void GLTFRenderer::createOcclusionBox() {
+    // Cubo [-1,1]³ (só posição importa; normal/UV zerados) anexado à arena
+    static const float corners[8][3] = {
+        {-1, -1, -1}, { 1, -1, -1}, { 1,  1, -1}, {-1,  1, -1},
+        {-1, -1,  1}, { 1, -1,  1}, { 1,  1,  1}, {-1,  1,  1}
+    };
+    static const unsigned int faces[36] = {
+        0, 2, 1, 0, 3, 2,  4, 5, 6, 4, 6, 7,  0, 1, 5, 0, 5, 4,
+        3, 7, 6, 3, 6, 2,  0, 4, 7, 0, 7, 3,  1, 2, 6, 1, 6, 5
+    };
+    occlusionBox.name = "__occlusion_box";
+    for (const auto& c : corners) {
+        occlusionBox.vertices.insert(occlusionBox.vertices.end(), {c[0], c[1], c[2], 0.0f, 0.0f, 0.0f, 0.0f, 0.0f});
+    }
+    occlusionBox.indices.assign(faces, faces + 36);
+    occlusionBox.isValid = setupMeshBuffers(occlusionBox);
+}
+
+void GLTFRenderer::applyOcclusion() {
+    frameIndex++;
+    occlusionQueries.clear();
+    occludedInstances.clear();
+    if (!occlusionCullingEnabled) return;
+    if (!occlusionBox.isValid) {
+        createOcclusionBox();
+        if (!occlusionBox.isValid) return;
+    }
+    occlusion.resize(instances.size());
+
+    // Fallback conservador: com a câmera andando rápido ou uma porta girando, a profundidade do frame
+    // anterior não representa mais a cena; desenha tudo o que passou pelo frustum (e testa de novo)
+    const glm::vec3& eye = frameState.cameraPos;
+    bool trustResults = glm::length(eye - lastOcclusionCameraPos) <= kOcclusionMaxStep && !frameState.doorsMoving;
+    lastOcclusionCameraPos = eye;
+
+    size_t kept = 0;
+    for (int idx : visibleInstances) {
+        auto& s = occlusion[idx];
+        // Ler o resultado só se já estiver pronto (nunca bloqueia o pipeline)
+        if (s.pending) {
+            GLuint available = 0;
+            glGetQueryObjectuiv(s.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint samplesPassed = 0;
+                glGetQueryObjectuiv(s.query, GL_QUERY_RESULT, &samplesPassed);
+                s.occluded = (samplesPassed == 0);
+                s.pending = false;
+            } else if (frameIndex - s.queryFrame > kOcclusionMaxLatency) {
+                s.occluded = false;
+            }
+        }
+        // Fora do frustum no frame anterior: o resultado é antigo demais
+        if (!trustResults || s.lastCandidateFrame + 1 != frameIndex) s.occluded = false;
+        s.lastCandidateFrame = frameIndex;
+
+        // Câmera dentro (ou quase) da caixa: as faces da frente seriam recortadas pelo near plane
+        const AABB& b = instanceBounds[idx];
+        float margin = kOcclusionPadding + kOcclusionNearMargin;
+        bool cameraInside = eye.x >= b.min.x - margin && eye.x <= b.max.x + margin &&
+                            eye.y >= b.min.y - margin && eye.y <= b.max.y + margin &&
+                            eye.z >= b.min.z - margin && eye.z <= b.max.z + margin;
+        if (cameraInside) s.occluded = false;
+        if (!s.pending && !cameraInside && idx != chaoInstanceIndex) occlusionQueries.push_back(idx);
+
+        if (s.occluded) {
+            occludedInstances.push_back(idx);
+        } else {
+            visibleInstances[kept++] = idx;
+        }
+    }
+    visibleInstances.resize(kept);
+    stats.instancesOccluded = (int)occludedInstances.size();
+}
+
+void GLTFRenderer::countSavedDraws() {
+    // Cada mesh escondido que não tem nenhuma outra instância visível é um comando de desenho a menos
+    stats.drawsSaved = 0;
+    if (occludedInstances.empty()) return;
+    meshSeen.assign(meshes.size(), 0);
+    for (int idx : batchedInstances) meshSeen[instances[idx].meshIndex] = 1;
+    for (int idx : occludedInstances) {
+        int meshIndex = instances[idx].meshIndex;
+        if (!meshSeen[meshIndex]) {
+            meshSeen[meshIndex] = 1;
+            stats.drawsSaved++;
+        }
+    }
+}
+
+glm::mat4 GLTFRenderer::occlusionBoxMatrix(int instanceIndex) const {
+    const AABB& b = instanceBounds[instanceIndex];
+    glm::vec3 center = (b.min + b.max) * 0.5f;
+    glm::vec3 halfExtent = (b.max - b.min) * 0.5f + glm::vec3(kOcclusionPadding);
+    return glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtent);
+}
+
+void GLTFRenderer::issueOcclusionQueries(size_t firstOffset, size_t stride) {
+    // Depois de toda a cena: caixas testadas contra a profundidade final, sem escrever cor/profundidade.
+    // Espera o VAO da arena ligado e os registros das caixas no anel a partir de firstOffset
+    stats.occlusionQueries = (int)occlusionQueries.size();
+    if (occlusionQueries.empty()) return;
+    // Variante mais simples: a cor é descartada de qualquer forma
+    useProgram(shaderProgram);
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+    glDepthMask(GL_FALSE);
+    for (size_t k = 0; k < occlusionQueries.size(); ++k) {
+        auto& s = occlusion[occlusionQueries[k]];
+        if (s.query == 0) glGenQueries(1, &s.query);
+        bindDrawRecords(firstOffset + k * stride);
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, s.query);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)occlusionBox.indexCount, occlusionBox.indexType,
+                                          (void*)occlusionBox.indexOffset,
+                                          1, occlusionBox.baseVertex);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        s.pending = true;
+        s.queryFrame = frameIndex;
+    }
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+void GLTFRenderer::toggleOcclusionCulling() {
+    occlusionCullingEnabled = !occlusionCullingEnabled;
+    std::cout << "Culling por oclusão: " << (occlusionCullingEnabled ? "ligado" : "desligado") << std::endl;
+}
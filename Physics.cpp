@@ -1,70 +1,175 @@
 #include "GLTFRenderer.h"
 
+// Chaves do clipe das portas: -90..90 graus em passos de kDoorKeyDegrees. A translação do nó é interpolada
+// em linha reta entre chaves (erro < 0.1% da largura da porta com 5 graus)
+static const float kDoorMaxAngle = 90.0f;
+static const float kDoorKeyDegrees = 5.0f;
+// Consulta de altura do chão dividida em jobs a partir deste número de caixas, em faixas de kQueryGrain
+static const size_t kParallelQueryMinBoxes = 8192;
+static const size_t kQueryGrain = 2048;
+
 void GLTFRenderer::initDoors() {
     std::cout << "Inicializando portas..." << std::endl; // Debug
-    // Evitar duplicatas quando chamado após múltiplos loadGLTF
+    // Evitar duplicatas quando chamado após múltiplos loadGLTF (portas abertas voltam a fechar).
+    // O clipe de cada porta é reaproveitado (mesmo nó, mesma dobradiça)
+    std::unordered_map<int, int> clipByNode;
+    for (const auto& d : doors) {
+        setNodeTransform(d.node, d.closedLocal);
+        animations.stop(d.clip);
+        animations.setTime(d.clip, kDoorMaxAngle / d.speed);
+        clipByNode[d.node] = d.clip;
+    }
     doors.clear();
     doorIndexByName.clear();
-    // Descobrir caixas e meshes das portas
-    auto findMeshIndexByName = [&](const std::string& n) -> int {
-        for (size_t i = 0; i < meshes.size(); ++i) {
-            if (meshes[i].name == n) return (int)i;
-        }
-        return -1;
-    };
-    for (const auto& box : collisionBoxes) {
+    for (auto& inst : instances) inst.doorIndex = -1;
+    instanceBatchesDirty = true; // portas não entram nos lotes estáticos fundidos
+    // Descobrir caixas e instâncias das portas (collisionBoxes[i] pertence a instances[i])
+    for (size_t boxIndex = 0; boxIndex < collisionBoxes.size(); ++boxIndex) {
+        const auto& box = collisionBoxes[boxIndex];
         std::cout << "Verificando mesh: '" << box.meshName << "'" << std::endl; // Debug
-        if (box.meshName == "porta_front_1" || box.meshName == "porta_front_2" || box.meshName == "porta_interna_1") {
-            std::cout << "Porta encontrada: " << box.meshName << std::endl; // Debug
-            Door d;
-            d.name = box.meshName;
-            d.meshIndex = findMeshIndexByName(box.meshName);
-            d.box = box;
-            d.hingeLeft = (box.meshName == "porta_front_1" || box.meshName == "porta_interna_1");
-            // Eixo de rotação: linha vertical no lado do batente.
-            // Escolhe o eixo de largura (maior entre X e Z) para usar o extremo correto.
-            glm::vec3 size = box.max - box.min;
-            bool widthIsX = std::abs(size.x) >= std::abs(size.z);
-            float hx, hz;
-            if (widthIsX) {
-                hx = d.hingeLeft ? box.min.x : box.max.x;
-                hz = (box.min.z + box.max.z) * 0.5f;
-            } else {
-                hx = (box.min.x + box.max.x) * 0.5f;
-                hz = d.hingeLeft ? box.min.z : box.max.z;
-            }
-            float hy = (box.min.y + box.max.y) * 0.5f;
-            d.hinge = glm::vec3(hx, hy, hz);
-            d.isOpen = false;
-            d.angle = 0.0f;
-            d.target = 0.0f;
-            int idx = (int)doors.size();
-            doors.push_back(d);
-            doorIndexByName[d.name] = idx;
+        const Mesh& mesh = meshes[instances[boxIndex].meshIndex];
+        if (!mesh.isDoor) continue;
+        // Primitivas do mesmo nó giram juntas: uma única porta com as caixas unidas
+        int node = instances[boxIndex].node;
+        int existing = -1;
+        for (size_t k = 0; k < doors.size(); ++k) {
+            if (doors[k].node == node) existing = (int)k;
         }
+        if (existing >= 0) {
+            doors[existing].box.min = glm::min(doors[existing].box.min, box.min);
+            doors[existing].box.max = glm::max(doors[existing].box.max, box.max);
+            instances[boxIndex].doorIndex = existing;
+            continue;
+        }
+        std::cout << "Porta encontrada: " << box.meshName << std::endl; // Debug
+        Door d;
+        d.name = box.meshName;
+        d.instanceIndex = (int)boxIndex;
+        d.box = box;
+        d.hingeLeft = mesh.doorHingeLeft;
+        d.node = node;
+        d.closedLocal = scene.local(node);
+        d.isOpen = false;
+        d.angle = 0.0f;
+        d.target = 0.0f;
+        int idx = (int)doors.size();
+        doors.push_back(d);
+        doorIndexByName[d.name] = idx;
+        instances[boxIndex].doorIndex = idx;
+    }
+    for (auto& d : doors) {
+        // Eixo de rotação: linha vertical no lado do batente.
+        // Escolhe o eixo de largura (maior entre X e Z) para usar o extremo correto.
+        const BoundingBox& box = d.box;
+        glm::vec3 size = box.max - box.min;
+        bool widthIsX = std::abs(size.x) >= std::abs(size.z);
+        float hx, hz;
+        if (widthIsX) {
+            hx = d.hingeLeft ? box.min.x : box.max.x;
+            hz = (box.min.z + box.max.z) * 0.5f;
+        } else {
+            hx = (box.min.x + box.max.x) * 0.5f;
+            hz = d.hingeLeft ? box.min.z : box.max.z;
+        }
+        float hy = (box.min.y + box.max.y) * 0.5f;
+        d.hinge = glm::vec3(hx, hy, hz);
+        auto reused = clipByNode.find(d.node);
+        d.clip = reused != clipByNode.end() ? reused->second : buildDoorClip(d);
     }
     std::cout << "Total de portas encontradas: " << doors.size() << std::endl; // Debug
 }
 
-void GLTFRenderer::updateDoors(float deltaTime) {
-    // Animar ângulo em direção ao alvo
+int GLTFRenderer::buildDoorClip(const Door& d) {
+    // Rotação em torno da dobradiça (eixo Y, espaço do mundo) levada para o espaço do pai do nó:
+    // local = pai⁻¹ * H * pai * local fechada, amostrada em T e R (a escala do nó não muda).
+    // Tempo = (ângulo + 90) / velocidade: fechada no meio do clipe. Filhos do nó (maçaneta etc.) giram junto
+    int parent = scene.parent(d.node);
+    glm::mat4 parentWorld = parent >= 0 ? scene.world(parent) : glm::mat4(1.0f);
+    glm::mat4 toParent = glm::inverse(parentWorld);
+    int keyCount = (int)(2.0f * kDoorMaxAngle / kDoorKeyDegrees) + 1;
+
+    AnimationSet set;
+    AnimationChannel translation, rotation;
+    translation.node = rotation.node = 0;
+    translation.path = (uint8_t)AnimationPath::Translation;
+    rotation.path = (uint8_t)AnimationPath::Rotation;
+    translation.interpolation = rotation.interpolation = (uint8_t)AnimationInterpolation::Linear;
+    translation.keyCount = rotation.keyCount = (uint32_t)keyCount;
+    rotation.firstValue = (uint32_t)keyCount * 3;
+    set.times.resize(keyCount);
+    set.values.resize(keyCount * 7);
+    for (int k = 0; k < keyCount; ++k) {
+        float angle = -kDoorMaxAngle + k * kDoorKeyDegrees;
+        glm::mat4 T1 = glm::translate(glm::mat4(1.0f), d.hinge);
+        glm::mat4 R = glm::rotate(glm::mat4(1.0f), glm::radians(angle), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 T0 = glm::translate(glm::mat4(1.0f), -d.hinge);
+        glm::vec3 position, scale;
+        glm::quat q;
+        decomposeTransform(toParent * (T1 * R * T0) * parentWorld * d.closedLocal, position, q, scale);
+        set.times[k] = (angle + kDoorMaxAngle) / d.speed;
+        float* t = &set.values[k * 3];
+        float* r = &set.values[rotation.firstValue + k * 4];
+        t[0] = position.x; t[1] = position.y; t[2] = position.z;
+        r[0] = q.x; r[1] = q.y; r[2] = q.z; r[3] = q.w;
+    }
+    set.channels = { translation, rotation };
+    AnimationClip clip;
+    clip.name = "porta:" + d.name;
+    clip.duration = set.times.back();
+    clip.channelCount = 2;
+    set.clips.push_back(clip);
+    int index = animations.addClips(set, std::vector<int>{ d.node }, scene);
+    animations.setTime(index, kDoorMaxAngle / d.speed);
+    return index;
+}
+
+void GLTFRenderer::syncDoorsWithClips() {
+    // Estado das portas (colisão, portais, oclusão) lido do tempo dos seus clipes
     for (auto& d : doors) {
-        if (std::abs(d.angle - d.target) < 0.1f) {
-            d.angle = d.target;
-            // Atualizar estado final somente quando atinge o alvo
-            d.isOpen = (std::abs(d.target) > 1.0f);
-            continue;
-        }
-        float dir = (d.angle < d.target) ? 1.0f : -1.0f;
-        d.angle += dir * d.speed * deltaTime;
-        if ((dir > 0.0f && d.angle > d.target) || (dir < 0.0f && d.angle < d.target)) {
+        if (animations.isPlaying(d.clip)) {
+            d.angle = animations.clipTime(d.clip) * d.speed - kDoorMaxAngle;
+        } else if (d.angle != d.target) {
             d.angle = d.target;
-            d.isOpen = (std::abs(d.target) > 1.0f);
+            d.isOpen = std::abs(d.target) > 1.0f;
         }
     }
 }
 
+int GLTFRenderer::playAnimation(const std::string& name, bool loop) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    int played = 0;
+    for (int clip : modelClips) {
+        if (animations.clipName(clip) != name) continue;
+        animations.play(clip, 1.0f, loop);
+        played++;
+    }
+    return played;
+}
+
+int GLTFRenderer::stopAnimation(const std::string& name) {
+    std::lock_guard<std::mutex> lock(simMutex);
+    int stopped = 0;
+    for (int clip : modelClips) {
+        if (animations.clipName(clip) != name) continue;
+        animations.stop(clip);
+        stopped++;
+    }
+    return stopped;
+}
+
+void GLTFRenderer::toggleAnimations() {
+    std::lock_guard<std::mutex> lock(simMutex);
+    modelAnimationsPlaying = !modelAnimationsPlaying;
+    for (int clip : modelClips) {
+        if (modelAnimationsPlaying) animations.play(clip, 1.0f, true);
+        else animations.stop(clip);
+    }
+    std::cout << "Animações dos modelos: " << (modelAnimationsPlaying ? "tocando" : "paradas") << " ("
+              << modelClips.size() << " clipes)" << std::endl;
+}
+
 void GLTFRenderer::toggleNearestDoor() {
+    std::lock_guard<std::mutex> lock(simMutex);
     std::cout << "Tentando abrir porta. Posição camera: " << cameraPos.x << ", " << cameraPos.z << std::endl; // Debug
     // Achar porta mais próxima em XZ dentro de um raio
     float bestDist2 = 5.0f * 5.0f; // Aumentar raio para 5 unidades
@@ -87,7 +192,8 @@ void GLTFRenderer::toggleNearestDoor() {
         float base = willOpen ? 90.0f : 0.0f;
         float sign = d.hingeLeft ? 1.0f : -1.0f;
         d.target = base * -sign; // abrir para fora
-        // Não altera d.isOpen aqui; será definido quando o ângulo alcançar o alvo
+        // Não altera d.isOpen aqui; será definido quando o clipe parar no alvo
+        animations.playTo(d.clip, (d.target + kDoorMaxAngle) / d.speed, 1.0f);
     } else {
         std::cout << "Nenhuma porta próxima encontrada" << std::endl; // Debug
     }
@@ -132,44 +238,60 @@ float GLTFRenderer::groundHeightAt(const glm::vec3& posXZ) {
         if (onChaoXZ) maxY = std::max(maxY, chaoY);
     }
 
-    for (const auto& box : collisionBoxes) {
-        // Procurar especificamente pelo nó/mesh chamado "escada"
-        if (box.meshName == "escada") {
-            // Verificar se (x,z) está dentro da projeção da AABB no plano XZ
-            bool insideXZ = (posXZ.x >= box.min.x && posXZ.x <= box.max.x &&
-                             posXZ.z >= box.min.z && posXZ.z <= box.max.z);
-            if (!insideXZ) continue;
-
-            // Dimensões da escada
-            glm::vec3 size = box.max - box.min; // tamanho AABB
-            float height = size.y;              // subida total
-
-            // Eixo principal no plano XZ (comprimento da escada)
-            // Escolhe o maior entre X e Z
-            bool alongX = std::abs(size.x) >= std::abs(size.z);
-            float length = alongX ? (box.max.x - box.min.x) : (box.max.z - box.min.z);
-            if (length <= 1e-5f) continue; // evitar divisão por zero
-
-            // Progresso ao longo do comprimento (0..1)
-            float t = alongX
-                ? (posXZ.x - box.min.x) / length
-                : (posXZ.z - box.min.z) / length;
-            t = glm::clamp(t, 0.0f, 1.0f);
-
-            // Altura da escada naquele ponto
-            // Interpolar a escada até atingir o nível do "chao" (se existir)
-            float stairTop = hasChao ? chaoY : (box.min.y + height);
-            float stairY = box.min.y + t * (stairTop - box.min.y);
-
-            // Manter o maior "chão" disponível (útil caso existam várias escadas)
-            if (stairY > maxY) maxY = stairY;
+    // Escadas: maior altura sob (x,z) numa faixa de caixas. Só lê estado; com muitas caixas as faixas viram jobs
+    auto scanStairs = [&](size_t begin, size_t end) {
+        float best = maxY;
+        for (size_t i = begin; i < end; ++i) {
+            const BoundingBox& box = collisionBoxes[i];
+            // Procurar especificamente pelo nó/mesh chamado "escada"
+            if (box.meshName == "escada") {
+                // Verificar se (x,z) está dentro da projeção da AABB no plano XZ
+                bool insideXZ = (posXZ.x >= box.min.x && posXZ.x <= box.max.x &&
+                                 posXZ.z >= box.min.z && posXZ.z <= box.max.z);
+                if (!insideXZ) continue;
+
+                // Dimensões da escada
+                glm::vec3 size = box.max - box.min; // tamanho AABB
+                float height = size.y;              // subida total
+
+                // Eixo principal no plano XZ (comprimento da escada)
+                // Escolhe o maior entre X e Z
+                bool alongX = std::abs(size.x) >= std::abs(size.z);
+                float length = alongX ? (box.max.x - box.min.x) : (box.max.z - box.min.z);
+                if (length <= 1e-5f) continue; // evitar divisão por zero
+
+                // Progresso ao longo do comprimento (0..1)
+                float t = alongX
+                    ? (posXZ.x - box.min.x) / length
+                    : (posXZ.z - box.min.z) / length;
+                t = glm::clamp(t, 0.0f, 1.0f);
+
+                // Altura da escada naquele ponto
+                // Interpolar a escada até atingir o nível do "chao" (se existir)
+                float stairTop = hasChao ? chaoY : (box.min.y + height);
+                float stairY = box.min.y + t * (stairTop - box.min.y);
+
+                // Manter o maior "chão" disponível (útil caso existam várias escadas)
+                if (stairY > best) best = stairY;
+            }
         }
+        return best;
+    };
+    if (collisionBoxes.size() >= kParallelQueryMinBoxes) {
+        size_t chunks = (collisionBoxes.size() + kQueryGrain - 1) / kQueryGrain;
+        std::vector<float> partial(chunks, maxY);
+        jobSystem().parallelFor(collisionBoxes.size(), kQueryGrain,
+                                [&](size_t begin, size_t end) { partial[begin / kQueryGrain] = scanStairs(begin, end); });
+        for (float y : partial) maxY = std::max(maxY, y);
+    } else {
+        maxY = scanStairs(0, collisionBoxes.size());
     }
     // Dar uma margem mínima para alcançar o topo mesmo com erros de ponto flutuante
     return maxY;
 }
 
 void GLTFRenderer::spawnInFrontOf(const std::string& meshName, float distance) {
+    std::lock_guard<std::mutex> lock(simMutex);
     // Encontrar a AABB do mesh desejado
     BoundingBox target{};
     bool found = false;
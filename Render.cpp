@@ -1,10 +1,144 @@
 #include "GLTFRenderer.h"
+#include <cstring>
+
+glm::mat4 GLTFRenderer::instanceWorldMatrix(int instanceIndex) const {
+    // Base do modelo + matriz de mundo do nó (portas giram pela matriz local do seu nó)
+    return model * scene.world(instances[instanceIndex].node);
+}
+
+void GLTFRenderer::setNodeTransform(int node, const glm::mat4& local) {
+    // Só marca: as matrizes de mundo são recalculadas uma vez por frame, em updateSceneTransforms
+    scene.setLocal(node, local);
+}
+
+void GLTFRenderer::updateSceneTransforms() {
+    // Subárvores com nós movidos: matrizes de mundo, AABBs e BVH só das instâncias presas a elas
+    scene.updateWorld(changedNodes);
+    for (int node : changedNodes) {
+        for (int i = nodeInstances[node]; i >= 0; i = instances[i].nextInNode) {
+            refitInstance(i);
+            // Quem se move sai dos grupos de fusão de vez (reagrupar a cada frame custaria O(instâncias))
+            MeshInstance& inst = instances[i];
+            if (inst.mergeGroup >= 0) instanceBatchesDirty = true;
+            inst.dynamic = true;
+        }
+    }
+}
+
+void GLTFRenderer::setInstanceTransform(int instanceIndex, const glm::mat4& world) {
+    // Matriz normal calculada só quando a instância muda (antes: inverse() por vértice no shader)
+    worldTransforms[instanceIndex] = world;
+    normalTransforms[instanceIndex] = glm::mat4(glm::transpose(glm::inverse(glm::mat3(world))));
+}
+
+void GLTFRenderer::rebuildInstanceBatches() {
+    // Instâncias estáticas (nem porta, nem "chao", nem já movidas) com a mesma matriz de mundo e material recebem o mesmo
+    // grupo: quando visíveis sozinhas, seus meshes são fundidos em um glMultiDrawElementsBaseVertex.
+    // Meshes compactos ficam de fora: cada um tem sua matriz de desquantização no registro de draw
+    std::vector<int> candidates;
+    for (size_t i = 0; i < instances.size(); ++i) {
+        instances[i].mergeGroup = -1;
+        if (instances[i].doorIndex < 0 && !instances[i].dynamic && (int)i != chaoInstanceIndex &&
+            !meshes[instances[i].meshIndex].compact) {
+            candidates.push_back((int)i);
+        }
+    }
+    // Um multi-draw tem um único tipo de índice: 16 e 32 bits ficam em grupos separados
+    auto indexType = [&](int i) { return meshes[instances[i].meshIndex].indexType; };
+    std::sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        int c = std::memcmp(&worldTransforms[a], &worldTransforms[b], sizeof(glm::mat4));
+        if (c != 0) return c < 0;
+        if (instances[a].materialId != instances[b].materialId) return instances[a].materialId < instances[b].materialId;
+        return indexType(a) < indexType(b);
+    });
+    mergeGroupCount = 0;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const auto& inst = instances[candidates[i]];
+        if (i == 0 || worldTransforms[candidates[i]] != worldTransforms[candidates[i - 1]] ||
+            inst.materialId != instances[candidates[i - 1]].materialId ||
+            indexType(candidates[i]) != indexType(candidates[i - 1])) {
+            mergeGroupCount++;
+        }
+        instances[candidates[i]].mergeGroup = mergeGroupCount - 1;
+    }
+    multiDrawGroups.assign(mergeGroupCount, MultiDrawGroup());
+    instanceBatchesDirty = false;
+}
+
+void GLTFRenderer::buildDrawLists() {
+    // Fila ordenada por estado/mesh: cada sequência com a mesma chave (sem a profundidade) vira um draw
+    buildRenderQueue();
+    batchedInstances.resize(renderQueue.size());
+    for (size_t i = 0; i < renderQueue.size(); ++i) batchedInstances[i] = renderQueue[i].transformIndex;
+    // Depois dos grupos de fusão ficam os grupos de clusters (um por instância), reaproveitados entre frames
+    for (auto& group : multiDrawGroups) {
+        group.counts.clear();
+        group.indexOffsets.clear();
+        group.baseVertices.clear();
+    }
+    size_t clusterGroup = (size_t)mergeGroupCount;
+    instanceBatches.clear();
+    size_t i = 0;
+    while (i < renderQueue.size()) {
+        uint64_t stateKey = renderQueue[i].key >> 16; // sem os bits de profundidade
+        size_t end = i + 1;
+        while (end < renderQueue.size() && (renderQueue[end].key >> 16) == stateKey) ++end;
+        int meshIndex = renderQueue[i].meshIndex;
+        int lod = renderQueue[i].lod;
+        const MeshInstance& inst = instances[renderQueue[i].transformIndex];
+        const auto& mesh = meshes[meshIndex];
+        if (end - i == 1 && inst.mergeGroup >= 0 && mesh.isValid) {
+            auto& g = multiDrawGroups[inst.mergeGroup];
+            if (g.counts.empty()) {
+                g.instanceSlot = (int)i;
+                g.materialId = inst.materialId;
+                g.indexType = mesh.indexType;
+            }
+            if (!appendVisibleClusters(renderQueue[i].transformIndex, g)) {
+                g.counts.push_back((GLsizei)mesh.lods[lod].indexCount);
+                g.indexOffsets.push_back((void*)mesh.lodIndexOffset(lod));
+                g.baseVertices.push_back(mesh.baseVertex);
+                stats.trianglesDrawn += (int)(mesh.lods[lod].indexCount / 3);
+            }
+        } else if (clusterCullingEnabled && !mesh.clusters.empty() && lod == 0 && mesh.isValid) {
+            // Mesh grande: cada instância vira um multi-draw só com os seus clusters visíveis
+            for (size_t k = i; k < end; ++k) {
+                if (clusterGroup == multiDrawGroups.size()) multiDrawGroups.emplace_back();
+                MultiDrawGroup& g = multiDrawGroups[clusterGroup];
+                g.instanceSlot = (int)k;
+                g.materialId = inst.materialId;
+                g.indexType = mesh.indexType;
+                g.compact = mesh.compact;
+                appendVisibleClusters(renderQueue[k].transformIndex, g);
+                if (!g.counts.empty()) clusterGroup++;
+            }
+        } else {
+            stats.trianglesDrawn += (int)(mesh.lods[lod].indexCount / 3 * (end - i));
+            // Um bloco de UBO comporta kDrawBlockCapacity registros: lotes maiores viram vários draws
+            for (size_t first = i; first < end; first += kDrawBlockCapacity) {
+                InstanceBatch batch;
+                batch.meshIndex = meshIndex;
+                batch.lod = lod;
+                batch.materialId = inst.materialId;
+                batch.firstInstance = (int)first;
+                batch.instanceCount = (int)std::min(end - first, (size_t)kDrawBlockCapacity);
+                instanceBatches.push_back(batch);
+            }
+        }
+        i = end;
+    }
+}
 
 void GLTFRenderer::render() {
+    // Câmera, portas e nós animados deste frame: dos snapshots da thread de simulação, dos dois últimos passos
+    // de updateSimulation (interpolados pela sobra do acumulador) ou do estado atual, se nada passou por eles
+    if (simulationThreadRunning()) consumeSnapshots();
+    else if (stepCurrent.tick != 0) applySnapshots(stepPrevious.tick != 0 ? stepPrevious : stepCurrent, stepCurrent, simAlpha);
+    else captureFrameState();
+
     glClearColor(0.53f, 0.81f, 0.92f, 1.0f); // Azul céu suave (RGB: 135, 206, 235)
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glUseProgram(shaderProgram);
     // Ajustar projeção ao tamanho atual do framebuffer (para fullscreen)
     GLint vp[4];
     glGetIntegerv(GL_VIEWPORT, vp);
@@ -12,25 +146,87 @@ void GLTFRenderer::render() {
     if (fbW > 0 && fbH > 0) {
         float aspect = (float)fbW / (float)fbH;
         projection = glm::perspective(glm::radians(45.0f), aspect, 0.01f, 200.0f);
+        // Altura em pixels de 1 unidade a 1 unidade de distância (escolha de LOD)
+        lodPixelsPerUnit = projection[1][1] * 0.5f * (float)fbH;
+    }
+    // view/projection/luz: um único upload por frame
+    updateFrameUniforms();
+
+    // Nós movidos desde o último frame (portas, animações, setNodeTransform)
+    updateSceneTransforms();
+
+    stats = RenderStats();
+    stats.instancesTotal = (int)instances.size();
+    stats.drawCalls = 1; // chão
+
+    if (!instances.empty()) {
+        if (instanceBatchesDirty) rebuildInstanceBatches();
+        cullInstances();
+        buildDrawLists();
+        countSavedDraws();
+        stats.instancesDrawn = (int)visibleInstances.size();
+        for (const auto& item : renderQueue) {
+            if (item.lod > 0) stats.instancesReduced++;
+        }
+        stats.instancesCulled = stats.instancesTotal - stats.instancesDrawn;
+    }
+
+    // Layout dos registros do frame no anel: chão, grupos de multi-draw, lotes e caixas de oclusão;
+    // cada ligação começa em um deslocamento alinhado
+    size_t cursor = 0;
+    size_t floorOffset = reserveDrawRecords(cursor, 1);
+    for (auto& group : multiDrawGroups) {
+        if (!group.counts.empty()) group.uboOffset = reserveDrawRecords(cursor, 1);
+    }
+    for (auto& batch : instanceBatches) {
+        batch.uboOffset = reserveDrawRecords(cursor, batch.instanceCount);
+    }
+    // Uma ligação por consulta; registros unitários consecutivos ficam igualmente espaçados
+    size_t queryOffset = 0, queryStride = 0;
+    for (size_t k = 0; k < occlusionQueries.size(); ++k) {
+        size_t offset = reserveDrawRecords(cursor, 1);
+        if (k == 0) queryOffset = offset;
+        if (k == 1) queryStride = offset - queryOffset;
+    }
+
+    // Escrever tudo de uma vez no trecho mapeado (sem sincronização)
+    DrawDataGPU* mapped = mapDrawRecords(cursor);
+    if (!mapped) {
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        return;
     }
-    setMatrix4("view", view);
-    setMatrix4("projection", projection);
-    setVec3("lightPos", cameraPos + glm::vec3(0.0f, 2.0f, 0.0f));
-    setVec3("viewPos", cameraPos);
-
-    // Renderizar chão com textura
-    setMatrix4("model", glm::mat4(1.0f));
-    setBool("useVertexColor", false);
-    setBool("useWorldTex", false); // Chão usa UVs normais
-    if (useFloorTexture && textureType > 0) {
-        setBool("useTexture", true);
+    auto recordAt = [&](size_t offset) { return (DrawDataGPU*)((char*)mapped + offset); };
+    DrawDataGPU* floorRecord = recordAt(floorOffset);
+    floorRecord->model = glm::mat4(1.0f);
+    floorRecord->normalMatrix = glm::mat4(1.0f);
+    floorRecord->color = glm::vec4(floorColor, 1.0f);
+    for (const auto& group : multiDrawGroups) {
+        if (!group.counts.empty()) writeInstanceRecord(*recordAt(group.uboOffset), batchedInstances[group.instanceSlot]);
+    }
+    for (const auto& batch : instanceBatches) {
+        DrawDataGPU* records = recordAt(batch.uboOffset);
+        for (int k = 0; k < batch.instanceCount; ++k) {
+            writeInstanceRecord(records[k], batchedInstances[batch.firstInstance + k]);
+        }
+    }
+    for (size_t k = 0; k < occlusionQueries.size(); ++k) {
+        DrawDataGPU* box = recordAt(queryOffset + k * queryStride);
+        box->model = occlusionBoxMatrix(occlusionQueries[k]);
+        box->normalMatrix = glm::mat4(1.0f);
+        box->color = glm::vec4(0.0f);
+    }
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Renderizar chão com textura (variante com ou sem textura)
+    boundMaterial = BoundMaterialState();
+    bool floorTextured = useFloorTexture && textureType > 0;
+    useProgram(shaderVariant(floorTextured ? SHADER_TEXTURE : 0u));
+    bindDrawRecords(floorOffset);
+    if (floorTextured) {
         glActiveTexture(GL_TEXTURE0);
         GLuint currentTexture = (textureType == 1) ? floorTexture : checkerTexture;
         glBindTexture(GL_TEXTURE_2D, currentTexture);
-        glUniform1i(glGetUniformLocation(shaderProgram, "ourTexture"), 0);
-    } else {
-        setBool("useTexture", false);
-        setVec3("baseColor", floorColor);
     }
     glBindVertexArray(floorVAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
@@ -38,67 +234,48 @@ void GLTFRenderer::render() {
     if (useFloorTexture) {
         glBindTexture(GL_TEXTURE_2D, 0);
     }
+    if (instances.empty()) return;
 
-    // Renderizar o modelo GLTF completo sem gradiente por vértice
-    if (!meshes.empty()) {
-        setBool("useVertexColor", false);
-        setBool("useTexture", false);
-        const glm::vec3 defaultColor = glm::vec3(0.82f, 0.82f, 0.82f); // cinza claro
-        for (size_t i = 0; i < meshes.size(); ++i) {
-            const auto& mesh = meshes[i];
-            if (!mesh.isValid) continue;
-
-            // Verificar se este mesh é uma porta com rotação
-            glm::mat4 m = model; // base do modelo
-            bool isDoor = false;
-            for (const auto& d : doors) {
-                if (d.meshIndex == (int)i) {
-                    isDoor = true;
-                    // Transformação de rotação em torno da dobradiça (eixo Y)
-                    glm::mat4 T1 = glm::translate(glm::mat4(1.0f), d.hinge);
-                    glm::mat4 R = glm::rotate(glm::mat4(1.0f), glm::radians(d.angle), glm::vec3(0.0f, 1.0f, 0.0f));
-                    glm::mat4 T0 = glm::translate(glm::mat4(1.0f), -d.hinge);
-                    m = model * (T1 * R * T0);
-                    break;
-                }
-            }
-            // Se for o mesh "chao", aplicar textura procedural com UVs em espaço-mundo
-            if ((int)i == chaoMeshIndex && chaoTexture != 0) {
-                setBool("useTexture", true);
-                setBool("useWorldTex", true);
-                glActiveTexture(GL_TEXTURE0);
-                glBindTexture(GL_TEXTURE_2D, chaoTexture);
-                glUniform1i(glGetUniformLocation(shaderProgram, "ourTexture"), 0);
-                glUniform1f(glGetUniformLocation(shaderProgram, "worldTexScale"), chaoWorldTexScale);
-            } else {
-                setBool("useWorldTex", false);
-                setBool("useTexture", false);
-            }
-
-            // Cores específicas por nome de mesh
-            // color_3        -> #938F86FF (147,143,134)
-            // titulo         -> #545761FF (84,87,97)
-            // Cube.036       -> #846945FF (132,105,69) - sofás
-            // Cylinder.005   -> #846945FF (132,105,69) - banco
-            // Cube           -> #846945FF (132,105,69) - tapete (mesma cor do sofá)
-            if (mesh.name == "color_3") {
-                setVec3("baseColor", glm::vec3(147.0f/255.0f, 143.0f/255.0f, 134.0f/255.0f));
-            } else if (mesh.name == "titulo") {
-                setVec3("baseColor", glm::vec3(84.0f/255.0f, 87.0f/255.0f, 97.0f/255.0f));
-            } else if (mesh.name == "Cube.036") {
-                setVec3("baseColor", glm::vec3(132.0f/255.0f, 105.0f/255.0f, 69.0f/255.0f));
-            } else if (mesh.name == "Cylinder.005") {
-                setVec3("baseColor", glm::vec3(132.0f/255.0f, 105.0f/255.0f, 69.0f/255.0f));
-            } else if (mesh.name == "Cube") {
-                setVec3("baseColor", glm::vec3(132.0f/255.0f, 105.0f/255.0f, 69.0f/255.0f)); // Mesma cor do sofá para tapete
-            } else {
-                setVec3("baseColor", defaultColor);
-            }
+    // Textura desconhecida após o chão: o primeiro bindMaterial com textura liga a sua
+    boundMaterial.material = -1;
+    boundMaterial.texture = 0;
+    // Uma arena por formato de vértice: grupos de fusão só usam a completa e os lotes chegam ordenados por
+    // formato, então o VAO troca poucas vezes (grupos de clusters compactos); por draw, só um bind de faixa do UBO
+    GLuint boundVAO = arena.VAO;
+    glBindVertexArray(boundVAO);
+    for (auto& group : multiDrawGroups) {
+        if (group.counts.empty()) continue;
+        GLuint vao = group.compact ? compactArena.VAO : arena.VAO;
+        if (vao != boundVAO) {
+            glBindVertexArray(vao);
+            boundVAO = vao;
+        }
+        bindMaterial(group.materialId, group.compact);
+        bindDrawRecords(group.uboOffset);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, group.counts.data(), group.indexType,
+                                      group.indexOffsets.data(), (GLsizei)group.counts.size(),
+                                      group.baseVertices.data());
+        stats.drawCalls++;
+    }
 
-            setMatrix4("model", m);
-            glBindVertexArray(mesh.VAO);
-            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
+    // Lotes já chegam ordenados por textura/material: trocas de estado só nas fronteiras
+    for (const auto& batch : instanceBatches) {
+        const auto& mesh = meshes[batch.meshIndex];
+        if (!mesh.isValid) continue;
+        GLuint vao = arenaFor(mesh).VAO;
+        if (vao != boundVAO) {
+            glBindVertexArray(vao);
+            boundVAO = vao;
         }
+        bindMaterial(batch.materialId, mesh.compact);
+        bindDrawRecords(batch.uboOffset);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)mesh.lods[batch.lod].indexCount, mesh.indexType,
+                                          (void*)mesh.lodIndexOffset(batch.lod),
+                                          batch.instanceCount, mesh.baseVertex);
+        stats.drawCalls++;
     }
+    // Caixas de oclusão estão na arena completa
+    if (boundVAO != arena.VAO) glBindVertexArray(arena.VAO);
+    issueOcclusionQueries(queryOffset, queryStride);
+    glBindVertexArray(0);
 }
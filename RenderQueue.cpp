@@ -0,0 +1,180 @@
+#include "GLTFRenderer.h"
+
+// Layout da chave de ordenação (64 bits, mais significativo primeiro): formato de vértice (VAO) no bit 63;
+// o LOD fica abaixo do mesh, então níveis diferentes do mesmo mesh são lotes diferentes
+static const int kKeyDepthBits = 16;
+static const int kKeyLodBits = 2;
+static const int kKeyMeshBits = 20;
+static const int kKeyMaterialBits = 12;
+static const int kKeyTextureBits = 8;
+static const int kKeyLodShift = kKeyDepthBits;
+static const int kKeyMeshShift = kKeyLodShift + kKeyLodBits;
+static const int kKeyMaterialShift = kKeyMeshShift + kKeyMeshBits;
+static const int kKeyTextureShift = kKeyMaterialShift + kKeyMaterialBits;
+static const int kKeyProgramShift = kKeyTextureShift + kKeyTextureBits;
+static const int kKeyFormatShift = 63;
+static_assert(kShaderVariantCount <= (1u << (kKeyFormatShift - kKeyProgramShift)), "variante não cabe na chave de ordenação");
+// Distância máxima considerada na profundidade (igual ao far plane)
+static const float kKeyMaxDepth = 200.0f;
+static_assert(kMaxMeshLods <= (1 << kKeyLodBits), "LOD não cabe na chave de ordenação");
+
+// Erro de simplificação tolerado na tela, em pixels, e a banda de histerese em torno dele
+// (evita que uma instância alterne de nível a cada frame perto do limiar)
+static const float kLodErrorPixels = 1.0f;
+static const float kLodHysteresis = 0.25f;
+
+// Fila de renderização montada em jobs a partir deste número de visíveis, em faixas de kQueueGrain itens
+static const size_t kParallelQueueMinItems = 2048;
+static const size_t kQueueGrain = 512;
+
+static uint64_t makeSortKey(bool compact, uint32_t program, uint32_t texture, uint32_t material, uint32_t mesh,
+                            uint32_t lod, float depth) {
+    auto field = [](uint32_t v, int bits) { return (uint64_t)std::min<uint32_t>(v, (1u << bits) - 1u); };
+    // Opacos de frente para trás dentro do mesmo estado (melhor rejeição precoce de profundidade)
+    float normalized = std::min(std::max(depth / kKeyMaxDepth, 0.0f), 1.0f);
+    uint64_t depthBits = (uint64_t)(normalized * (float)((1u << kKeyDepthBits) - 1u));
+    return ((uint64_t)compact << kKeyFormatShift) |
+           ((uint64_t)program << kKeyProgramShift) |
+           (field(texture, kKeyTextureBits) << kKeyTextureShift) |
+           (field(material, kKeyMaterialBits) << kKeyMaterialShift) |
+           (field(mesh, kKeyMeshBits) << kKeyMeshShift) |
+           ((uint64_t)lod << kKeyLodShift) |
+           depthBits;
+}
+
+static void radixSortDrawItems(std::vector<DrawItem>& items, std::vector<DrawItem>& scratch) {
+    // LSD com dígitos de 8 bits (estável); passadas em que todos têm o mesmo dígito são puladas
+    if (items.size() < 2) return;
+    scratch.resize(items.size());
+    size_t counts[256];
+    for (int shift = 0; shift < 64; shift += 8) {
+        std::fill(counts, counts + 256, 0);
+        for (const auto& item : items) counts[(item.key >> shift) & 0xFF]++;
+        if (counts[(items[0].key >> shift) & 0xFF] == items.size()) continue;
+        size_t sum = 0;
+        for (size_t& c : counts) {
+            size_t n = c;
+            c = sum;
+            sum += n;
+        }
+        for (const auto& item : items) scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+        items.swap(scratch);
+    }
+}
+
+int GLTFRenderer::materialForMesh(const std::string& meshName) {
+    // Cores específicas por nome de mesh (resolvidas uma vez, no carregamento)
+    // color_3        -> #938F86FF (147,143,134)
+    // titulo         -> #545761FF (84,87,97)
+    // Cube.036       -> #846945FF (132,105,69) - sofás
+    // Cylinder.005   -> #846945FF (132,105,69) - banco
+    // Cube           -> #846945FF (132,105,69) - tapete (mesma cor do sofá)
+    // chao           -> textura de pedra com UVs em espaço-mundo
+    std::string materialName = "padrao";
+    Material material; // cinza claro
+    if (meshName == "color_3") {
+        materialName = "color_3";
+        material.color = glm::vec3(147.0f/255.0f, 143.0f/255.0f, 134.0f/255.0f);
+    } else if (meshName == "titulo") {
+        materialName = "titulo";
+        material.color = glm::vec3(84.0f/255.0f, 87.0f/255.0f, 97.0f/255.0f);
+    } else if (meshName == "Cube.036" || meshName == "Cylinder.005" || meshName == "Cube") {
+        materialName = "marrom";
+        material.color = glm::vec3(132.0f/255.0f, 105.0f/255.0f, 69.0f/255.0f);
+    } else if (meshName == "chao") {
+        materialName = "chao";
+        material.texture = chaoTexture; // pode ser 0 aqui; loadGLTF atualiza ao criar a textura
+        material.worldTex = true;
+    }
+
+    auto found = materialIndexByName.find(materialName);
+    if (found != materialIndexByName.end()) return found->second;
+    int id = (int)materials.size();
+    materials.push_back(material);
+    materialIndexByName[materialName] = id;
+    if (materialName == "chao") chaoMaterialId = id;
+    return id;
+}
+
+void GLTFRenderer::buildRenderQueue() {
+    // Um item por instância visível; só inteiros e floats (nenhum nome é consultado aqui).
+    // Cada item escreve só o próprio slot e o LOD da própria instância: faixas independentes viram jobs
+    renderQueue.resize(visibleInstances.size());
+    auto fillItems = [this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            int idx = visibleInstances[i];
+            const MeshInstance& inst = instances[idx];
+            const Material& mat = materials[inst.materialId];
+            const AABB& b = instanceBounds[idx];
+            float depth = glm::length((b.min + b.max) * 0.5f - frameState.cameraPos);
+            int lod = selectInstanceLod(idx);
+            DrawItem& item = renderQueue[i];
+            bool compact = meshes[inst.meshIndex].compact;
+            item.key = makeSortKey(compact, materialShaderFeatures(inst.materialId, compact), mat.texture,
+                                   (uint32_t)inst.materialId, (uint32_t)inst.meshIndex, (uint32_t)lod, depth);
+            item.meshIndex = inst.meshIndex;
+            item.lod = lod;
+            item.transformIndex = idx;
+        }
+    };
+    if (visibleInstances.size() >= kParallelQueueMinItems) {
+        jobSystem().parallelFor(visibleInstances.size(), kQueueGrain, fillItems);
+    } else {
+        fillItems(0, visibleInstances.size());
+    }
+    radixSortDrawItems(renderQueue, renderQueueScratch);
+}
+
+int GLTFRenderer::selectInstanceLod(int instanceIndex) {
+    // Erro geométrico de cada nível projetado na tela: erro * escala da instância * pixels por unidade / distância
+    // até a AABB. Fica no nível atual enquanto ele estiver dentro da banda de histerese
+    MeshInstance& inst = instances[instanceIndex];
+    const Mesh& mesh = meshes[inst.meshIndex];
+    if (!lodEnabled || mesh.lodCount <= 1) return inst.lod = 0;
+    const glm::mat4& world = worldTransforms[instanceIndex];
+    float scale = std::max(glm::length(glm::vec3(world[0])),
+                  std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+    const AABB& b = instanceBounds[instanceIndex];
+    glm::vec3 closest = glm::clamp(frameState.cameraPos, b.min, b.max);
+    float distance = std::max(glm::length(closest - frameState.cameraPos), 0.01f);
+    float pixelsPerError = scale * lodPixelsPerUnit / distance;
+    auto projected = [&](int lod) { return mesh.lods[lod].error * pixelsPerError; };
+
+    int lod = std::min(inst.lod, mesh.lodCount - 1);
+    while (lod > 0 && projected(lod) > kLodErrorPixels * (1.0f + kLodHysteresis)) --lod;
+    while (lod + 1 < mesh.lodCount && projected(lod + 1) < kLodErrorPixels * (1.0f - kLodHysteresis)) ++lod;
+    return inst.lod = lod;
+}
+
+void GLTFRenderer::toggleLod() {
+    lodEnabled = !lodEnabled;
+    std::cout << "Níveis de detalhe: " << (lodEnabled ? "ligados" : "desligados") << std::endl;
+}
+
+uint32_t GLTFRenderer::materialShaderFeatures(int materialId, bool compact) const {
+    // Avaliado por frame: a textura do "chao" pode surgir depois de o material ser criado.
+    // O formato do vértice só importa para a cor por posição (as outras variantes servem aos dois)
+    const Material& mat = materials[materialId];
+    if (mat.texture == 0) return mat.vertexColor ? SHADER_VERTEX_COLOR | (compact ? SHADER_COMPACT_POS : 0u) : 0u;
+    return SHADER_TEXTURE | (mat.worldTex ? SHADER_WORLD_TEX : 0u);
+}
+
+void GLTFRenderer::useProgram(GLuint program) {
+    if (program == boundMaterial.program) return;
+    glUseProgram(program);
+    boundMaterial.program = program;
+}
+
+void GLTFRenderer::bindMaterial(int materialId, bool compact) {
+    // Variante do shader e textura só quando mudam; cor vai no registro de draw
+    if (materialId == boundMaterial.material && compact == boundMaterial.compact) return;
+    boundMaterial.material = materialId;
+    boundMaterial.compact = compact;
+    const Material& mat = materials[materialId];
+    useProgram(shaderVariant(materialShaderFeatures(materialId, compact)));
+    if (mat.texture != 0 && mat.texture != boundMaterial.texture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, mat.texture);
+        boundMaterial.texture = mat.texture;
+    }
+}
@@ -0,0 +1,189 @@
+#include "GLTFRenderer.h"
+
+// Porta conta como passagem aberta acima deste ângulo (mesmo limiar da colisão)
+static const float kPortalOpenAngle = 5.0f;
+// Folga para considerar uma instância contida em uma sala
+static const float kRoomTolerance = 0.05f;
+
+static bool overlaps(const AABB& a, const AABB& b) {
+    return a.min.x < b.max.x && a.max.x > b.min.x &&
+           a.min.y < b.max.y && a.max.y > b.min.y &&
+           a.min.z < b.max.z && a.max.z > b.min.z;
+}
+
+static bool containsBox(const AABB& outer, const AABB& inner) {
+    return inner.min.x >= outer.min.x - kRoomTolerance && inner.max.x <= outer.max.x + kRoomTolerance &&
+           inner.min.y >= outer.min.y - kRoomTolerance && inner.max.y <= outer.max.y + kRoomTolerance &&
+           inner.min.z >= outer.min.z - kRoomTolerance && inner.max.z <= outer.max.z + kRoomTolerance;
+}
+
+bool GLTFRenderer::parseRooms(const std::string& roomsPath, std::vector<Room>& outRooms,
+                              std::vector<Portal>& outPortals) const {
+    // Formato (uma entrada por linha, '#' comenta):
+    //   room   <nome> minX minY minZ maxX maxY maxZ
+    //   portal <nome do mesh> <salaA> <salaB>      ("fora" = tudo que não está em nenhuma sala)
+    // Lido uma vez por asset, no espaço do asset; addRooms leva cada cópia para o mundo
+    outRooms.clear();
+    outPortals.clear();
+    std::ifstream file(roomsPath);
+    if (!file.is_open()) return false;
+
+    Room outside;
+    outside.name = "fora";
+    outRooms.push_back(outside);
+    auto roomIndex = [&](const std::string& name) -> int {
+        for (size_t i = 0; i < outRooms.size(); ++i) {
+            if (outRooms[i].name == name) return (int)i;
+        }
+        return -1;
+    };
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line = line.substr(0, hash);
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind)) continue;
+        if (kind == "room") {
+            Room room;
+            glm::vec3 mn, mx;
+            if (!(in >> room.name >> mn.x >> mn.y >> mn.z >> mx.x >> mx.y >> mx.z)) {
+                std::cerr << roomsPath << ":" << lineNumber << ": sala inválida" << std::endl;
+                continue;
+            }
+            room.bounds.min = mn;
+            room.bounds.max = mx;
+            outRooms.push_back(room);
+        } else if (kind == "portal") {
+            Portal portal;
+            std::string a, b;
+            if (!(in >> portal.name >> a >> b) || roomIndex(a) < 0 || roomIndex(b) < 0) {
+                std::cerr << roomsPath << ":" << lineNumber << ": portal inválido" << std::endl;
+                continue;
+            }
+            portal.roomA = roomIndex(a);
+            portal.roomB = roomIndex(b);
+            outPortals.push_back(portal);
+        }
+    }
+    std::cout << "Salas carregadas de '" << roomsPath << "': " << outRooms.size() - 1 << " salas, "
+              << outPortals.size() << " portais" << std::endl;
+    return true;
+}
+
+void GLTFRenderer::addRooms(const std::vector<Room>& assetRooms, const std::vector<Portal>& assetPortals,
+                            const glm::mat4& baseTransform, size_t firstInstance) {
+    if (assetRooms.empty()) return;
+    if (rooms.empty()) {
+        Room outside;
+        outside.name = "fora";
+        rooms.push_back(outside);
+    }
+    // A sala 0 do asset é o "fora" comum; as demais entram no fim, no mundo desta cópia
+    int offset = (int)rooms.size() - 1;
+    for (size_t r = 1; r < assetRooms.size(); ++r) {
+        Room room = assetRooms[r];
+        room.bounds = transformAABB(baseTransform, room.bounds.min, room.bounds.max);
+        rooms.push_back(room);
+    }
+    for (const auto& source : assetPortals) {
+        Portal portal = source;
+        portal.roomA = source.roomA > 0 ? source.roomA + offset : 0;
+        portal.roomB = source.roomB > 0 ? source.roomB + offset : 0;
+        // Passagem presa às instâncias desta cópia (as de outra cópia abrem os portais dela)
+        portal.instanceIndex = -1;
+        for (size_t i = firstInstance; i < collisionBoxes.size(); ++i) {
+            if (collisionBoxes[i].meshName == portal.name) { portal.instanceIndex = (int)i; break; }
+        }
+        portals.push_back(portal);
+    }
+    bvhDirty = true;
+}
+
+void GLTFRenderer::assignRooms() {
+    // Sem salas: tudo é global (só o frustum culling atua)
+    instanceRoom.assign(instances.size(), -1);
+    visibleRooms.assign(rooms.size(), 1);
+    if (rooms.empty()) return;
+
+    // Instância contida em uma única sala pertence a ela; a que não toca nenhuma sala fica "fora";
+    // o que cruza o limite de uma sala (paredes, portas, piso, casca do prédio) é global
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const AABB& box = instanceBounds[i];
+        int room = 0;
+        for (size_t r = 1; r < rooms.size(); ++r) {
+            if (!overlaps(box, rooms[r].bounds)) continue;
+            if (room == 0 && containsBox(rooms[r].bounds, box)) {
+                room = (int)r;
+            } else {
+                room = -1;
+                break;
+            }
+        }
+        instanceRoom[i] = room;
+    }
+
+    // Portas atuais dos portais (initDoors refaz a lista a cada asset instanciado)
+    for (auto& portal : portals) {
+        portal.doorIndex = -1;
+        if (portal.instanceIndex < 0) continue;
+        portal.doorIndex = instances[portal.instanceIndex].doorIndex;
+        // A própria porta/janela precisa aparecer dos dois lados
+        instanceRoom[portal.instanceIndex] = -1;
+    }
+}
+
+int GLTFRenderer::roomAt(const glm::vec3& pos) const {
+    for (size_t r = 1; r < rooms.size(); ++r) {
+        const AABB& b = rooms[r].bounds;
+        if (pos.x >= b.min.x && pos.x <= b.max.x &&
+            pos.y >= b.min.y && pos.y <= b.max.y &&
+            pos.z >= b.min.z && pos.z <= b.max.z) {
+            return (int)r;
+        }
+    }
+    return 0;
+}
+
+void GLTFRenderer::computeVisibleRooms(const Frustum& frustum) {
+    stats.roomsTotal = (int)rooms.size();
+    if (!portalCullingEnabled || rooms.empty()) {
+        visibleRooms.assign(rooms.size(), 1);
+        stats.roomsVisible = stats.roomsTotal;
+        return;
+    }
+
+    // Busca em largura a partir da sala da câmera, atravessando só portais abertos e no frustum
+    visibleRooms.assign(rooms.size(), 0);
+    roomQueue.clear();
+    int start = roomAt(frameState.cameraPos);
+    visibleRooms[start] = 1;
+    roomQueue.push_back(start);
+    for (size_t head = 0; head < roomQueue.size(); ++head) {
+        int current = roomQueue[head];
+        for (const auto& portal : portals) {
+            if (portal.roomA != current && portal.roomB != current) continue;
+            int other = (portal.roomA == current) ? portal.roomB : portal.roomA;
+            if (visibleRooms[other] || portal.instanceIndex < 0) continue;
+            // Ângulo do frame (a lista pode estar um tick atrás de um initDoors: porta nova conta como aberta)
+            if (portal.doorIndex >= 0 && portal.doorIndex < (int)frameState.doorAngles.size() &&
+                std::abs(frameState.doorAngles[portal.doorIndex]) <= kPortalOpenAngle) continue;
+            // Caixa fechada da passagem (a porta girando continua dentro do vão + folga)
+            AABB opening;
+            opening.min = collisionBoxes[portal.instanceIndex].min;
+            opening.max = collisionBoxes[portal.instanceIndex].max;
+            if (classifyAABB(frustum, opening) == 0) continue;
+            visibleRooms[other] = 1;
+            roomQueue.push_back(other);
+        }
+    }
+    stats.roomsVisible = (int)roomQueue.size();
+}
+
+void GLTFRenderer::togglePortalCulling() {
+    portalCullingEnabled = !portalCullingEnabled;
+    std::cout << "Culling por portais: " << (portalCullingEnabled ? "ligado" : "desligado") << std::endl;
+}
@@ -0,0 +1,43 @@
+#include "SceneGraph.h"
+#include <algorithm>
+
+int SceneGraph::addNode(int parent, const glm::mat4& local) {
+    int node = (int)parents.size();
+    if (parent >= node || (parent >= 0 && subtreeEnds[parent] != node)) return -1;
+    parents.push_back(parent);
+    subtreeEnds.push_back(node + 1);
+    locals.push_back(local);
+    worlds.push_back(parent >= 0 ? worlds[parent] * local : local);
+    dirty.push_back(0);
+    // A subárvore de todos os ancestrais passa a incluir o novo nó
+    for (int a = parent; a >= 0; a = parents[a]) subtreeEnds[a] = node + 1;
+    return node;
+}
+
+void SceneGraph::setLocal(int node, const glm::mat4& local) {
+    locals[node] = local;
+    if (!dirty[node]) {
+        dirty[node] = 1;
+        dirtyRoots.push_back(node);
+    }
+}
+
+void SceneGraph::updateWorld(std::vector<int>& changed) {
+    changed.clear();
+    if (dirtyRoots.empty()) return;
+    // Em ordem de índice: um ancestral marcado vem antes e sua faixa já cobre os descendentes marcados
+    std::sort(dirtyRoots.begin(), dirtyRoots.end());
+    int coveredEnd = 0;
+    for (int root : dirtyRoots) {
+        if (root < coveredEnd) continue;
+        // Pré-ordem: o pai de cada nó da faixa já foi atualizado (ou está fora dela, limpo)
+        for (int node = root; node < subtreeEnds[root]; ++node) {
+            int p = parents[node];
+            worlds[node] = p >= 0 ? worlds[p] * locals[node] : locals[node];
+            dirty[node] = 0;
+            changed.push_back(node);
+        }
+        coveredEnd = subtreeEnds[root];
+    }
+    dirtyRoots.clear();
+}
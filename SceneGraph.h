@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+// Grafo de cena retido: nós em pré-ordem (pai antes dos filhos, cada subárvore contígua) com as matrizes
+// locais e de mundo em arrays próprios (SoA). setLocal só marca o nó; updateWorld recalcula as subárvores
+// marcadas, então mover um objeto custa O(nós da subárvore), sem tocar no resto da cena nem na GPU
+class SceneGraph {
+public:
+    // Novo nó como último filho de parent (-1 = raiz). A subárvore de parent precisa terminar no fim dos
+    // arrays (construção em profundidade, como no carregamento); retorna -1 caso contrário.
+    // A matriz de mundo é calculada na hora a partir da do pai
+    int addNode(int parent, const glm::mat4& local);
+
+    void setLocal(int node, const glm::mat4& local);
+    // Recalcula o mundo das subárvores marcadas; changed recebe os nós atualizados, em pré-ordem
+    void updateWorld(std::vector<int>& changed);
+
+    size_t size() const { return parents.size(); }
+    int parent(int node) const { return parents[node]; }
+    const glm::mat4& local(int node) const { return locals[node]; }
+    const glm::mat4& world(int node) const { return worlds[node]; }
+
+private:
+    std::vector<int> parents;
+    std::vector<int> subtreeEnds; // fim (exclusivo) da subárvore de cada nó
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<uint8_t> dirty;
+    std::vector<int> dirtyRoots;  // nós com setLocal desde o último updateWorld
+};
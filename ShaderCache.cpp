@@ -0,0 +1,100 @@
+#include "GLTFRenderer.h"
+#include <cstring>
+#include <filesystem>
+
+// Binários de programa gravados por chave (hash das fontes + #define + driver)
+static const char* kShaderCacheDir = "shader_cache";
+static const uint32_t kShaderCacheMagic = 0x43534A54; // "TJSC"
+static const uint32_t kShaderCacheVersion = 1;
+
+struct ProgramBinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+uint64_t fnv1a64(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string cachePathForKey(uint64_t key) {
+    std::ostringstream path;
+    path << kShaderCacheDir << "/" << std::hex << std::setw(16) << std::setfill('0') << key << ".bin";
+    return path.str();
+}
+
+void GLTFRenderer::initProgramBinaryCache() {
+    // O binário só vale para o mesmo driver/GPU: fabricante, renderer e versão entram na chave
+    programBinarySupported = GLEW_ARB_get_program_binary || GLEW_VERSION_4_1;
+    GLint formats = 0;
+    if (programBinarySupported) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (formats <= 0) programBinarySupported = false;
+    driverSignature.clear();
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const GLubyte* value = glGetString(name);
+        driverSignature += value ? (const char*)value : "?";
+        driverSignature += '\n';
+    }
+    std::cout << "Cache de binários de shader: " << (programBinarySupported ? "ativo" : "indisponível") << std::endl;
+}
+
+uint64_t GLTFRenderer::programCacheKey(const std::string& shaderText) const {
+    uint64_t hash = fnv1a64(shaderText.data(), shaderText.size());
+    return fnv1a64(driverSignature.data(), driverSignature.size(), hash);
+}
+
+GLuint GLTFRenderer::loadCachedProgram(uint64_t key) {
+    if (!programBinarySupported) return 0;
+    std::ifstream file(cachePathForKey(key), std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    ProgramBinaryHeader header;
+    if (!file.read((char*)&header, sizeof(header)) || header.magic != kShaderCacheMagic ||
+        header.version != kShaderCacheVersion || header.key != key || header.length == 0) {
+        return 0;
+    }
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), binary.size())) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, (GLenum)header.format, binary.data(), (GLsizei)binary.size());
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // Driver atualizado ou binário corrompido: descartar e recompilar das fontes
+        std::cerr << "Binário de shader em cache rejeitado pelo driver; recompilando" << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void GLTFRenderer::storeCachedProgram(uint64_t key, GLuint program) {
+    if (!programBinarySupported) return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return;
+
+    std::error_code ec;
+    std::filesystem::create_directories(kShaderCacheDir, ec);
+    std::ofstream file(cachePathForKey(key), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Não foi possível gravar o cache de shader em '" << kShaderCacheDir << "'" << std::endl;
+        return;
+    }
+    ProgramBinaryHeader header = { kShaderCacheMagic, kShaderCacheVersion, key, (uint32_t)format, (uint32_t)written };
+    file.write((const char*)&header, sizeof(header));
+    file.write(binary.data(), written);
+}
@@ -0,0 +1,194 @@
+#include "GLTFRenderer.h"
+#include <chrono>
+#include <cmath>
+
+// Passo fixo da simulação (nas duas formas: thread própria ou updateSimulation). A 3 u/s a câmera anda
+// 2,5 cm por passo, menos que a espessura das caixas das portas: não há como atravessá-las
+static const int64_t kSimTicksPerSecond = 120;
+static const double kSimTickSeconds = 1.0 / kSimTicksPerSecond;
+// O acumulador de updateSimulation conta nanossegundos × kSimTicksPerSecond: nessa unidade um passo vale
+// exatamente 1e9 e a soma dos frames nunca perde um passo por arredondamento
+static const int64_t kSimTickUnits = 1000000000;
+// Depois de um travamento (depurador, janela arrastada) a simulação descarta o atraso em vez de rodar
+// uma rajada de passos para alcançar o relógio. 0,25 s: frames lentos de cenas pesadas (até 4 FPS) ainda
+// andam em tempo real; só pausas de verdade perdem tempo
+static const int kSimMaxCatchUpTicks = 30;
+
+// Relógio comum às duas threads (o instante de cada snapshot e o instante desenhado)
+static double simulationClock() {
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point start = Clock::now();
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static bool samePose(const NodePose& a, const NodePose& b) {
+    return a.node == b.node && a.translation == b.translation && a.rotation == b.rotation && a.scale == b.scale;
+}
+
+void GLTFRenderer::updateSimulation(double elapsedSeconds, const SimInput& input) {
+    // O mesmo movimento com qualquer taxa de quadros (e com ou sem VSync): só passos inteiros, o resto fica
+    // para o próximo frame e vira a fração de interpolação deste
+    std::lock_guard<std::mutex> lock(simMutex);
+    double elapsed = std::min(std::max(elapsedSeconds, 0.0), kSimMaxCatchUpTicks * kSimTickSeconds);
+    int64_t units = std::llround(elapsed * (double)(kSimTicksPerSecond * kSimTickUnits));
+    simAccumulator = std::min(simAccumulator + units, kSimMaxCatchUpTicks * kSimTickUnits);
+    while (simAccumulator >= kSimTickUnits) {
+        std::swap(stepPrevious, stepCurrent);
+        advanceSimulation((float)kSimTickSeconds, input);
+        ++simTick;
+        writeSnapshot(stepCurrent, simTick, simTick * kSimTickSeconds);
+        simAccumulator -= kSimTickUnits;
+    }
+    simAlpha = (float)((double)simAccumulator / kSimTickUnits);
+}
+
+void GLTFRenderer::advanceSimulation(float deltaTime, const SimInput& input) {
+    // Andar, subir/descer, girar; depois portas e clipes (só o estado interno: o grafo é da thread do GL)
+    bool moving = false;
+    for (int d = 0; d < 4; ++d) {
+        if (input.move[d]) processMovement(d, deltaTime);
+        moving = moving || input.move[d];
+    }
+    if (moving) followGround(deltaTime);
+    for (int d = 0; d < 2; ++d) {
+        if (input.vertical[d]) processVerticalMovement(d, deltaTime);
+    }
+    for (int d = 0; d < 4; ++d) {
+        if (input.rotate[d]) processKeyboardRotation(d, deltaTime);
+    }
+    animations.advance(deltaTime);
+    syncDoorsWithClips();
+}
+
+void GLTFRenderer::startSimulationThread() {
+    if (simThread.joinable()) return;
+    // Criado aqui (thread do GL): a simulação também usa jobs (groundHeightAt com muitas caixas)
+    jobSystem();
+    // Primeiro snapshot antes de a thread existir: o primeiro frame já tem câmera, portas e poses
+    writeSnapshot(snapshots.writeBuffer(), 1, simulationClock());
+    snapshots.publish();
+    previousSnapshot = FrameSnapshot();
+    simStopping.store(false);
+    simThread = std::thread(&GLTFRenderer::simulationLoop, this);
+    std::cout << "Thread de simulação ligada (" << 1.0 / kSimTickSeconds << " Hz)" << std::endl;
+}
+
+void GLTFRenderer::stopSimulationThread() {
+    if (!simThread.joinable()) return;
+    simStopping.store(true);
+    simThread.join();
+    // Pose do último tick no grafo: daqui em diante a simulação volta a rodar na thread do GL, a partir dele
+    snapshots.acquire();
+    applySnapshots(snapshots.readBuffer(), snapshots.readBuffer(), 1.0f);
+    stepCurrent = snapshots.readBuffer();
+    stepPrevious = stepCurrent;
+    simTick = stepCurrent.tick;
+    simAccumulator = 0;
+    simAlpha = 1.0f;
+    std::cout << "Thread de simulação desligada" << std::endl;
+}
+
+void GLTFRenderer::setSimulationInput(const SimInput& input) {
+    std::lock_guard<std::mutex> lock(simInputMutex);
+    simInput = input;
+}
+
+void GLTFRenderer::simulationLoop() {
+    uint64_t tick = 1;
+    double next = simulationClock() + kSimTickSeconds;
+    while (!simStopping.load()) {
+        double now = simulationClock();
+        if (now < next) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(next - now));
+            continue;
+        }
+        if (now - next > kSimMaxCatchUpTicks * kSimTickSeconds) next = now;
+        SimInput input;
+        {
+            std::lock_guard<std::mutex> lock(simInputMutex);
+            input = simInput;
+        }
+        {
+            // Cargas e comandos da thread do GL (portas, clipes, caixas de colisão) esperam o fim do tick
+            std::lock_guard<std::mutex> lock(simMutex);
+            advanceSimulation((float)kSimTickSeconds, input);
+            writeSnapshot(snapshots.writeBuffer(), ++tick, next);
+        }
+        snapshots.publish();
+        next += kSimTickSeconds;
+    }
+}
+
+void GLTFRenderer::writeSnapshot(FrameSnapshot& snapshot, uint64_t tick, double time) {
+    snapshot.tick = tick;
+    snapshot.time = time;
+    snapshot.cameraPos = cameraPos;
+    snapshot.yaw = yaw;
+    snapshot.pitch = pitch;
+    snapshot.doorAngles.resize(doors.size());
+    snapshot.doorsMoving = false;
+    for (size_t i = 0; i < doors.size(); ++i) {
+        snapshot.doorAngles[i] = doors[i].angle;
+        if (doors[i].angle != doors[i].target) snapshot.doorsMoving = true;
+    }
+    animations.copyPoses(snapshot.poses);
+}
+
+void GLTFRenderer::consumeSnapshots() {
+    // O atual vira o anterior só quando chega um novo; a thread do GL nunca espera a simulação
+    if (snapshots.fresh()) {
+        previousSnapshot = snapshots.readBuffer();
+        snapshots.acquire();
+    }
+    const FrameSnapshot& current = snapshots.readBuffer();
+    const FrameSnapshot& previous = previousSnapshot.tick != 0 ? previousSnapshot : current;
+    // Desenha um tick atrás do relógio: o instante desenhado cai entre os dois últimos snapshots
+    float alpha = 1.0f;
+    if (current.time > previous.time) {
+        double renderTime = simulationClock() - kSimTickSeconds;
+        alpha = (float)((renderTime - previous.time) / (current.time - previous.time));
+        alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+    }
+    applySnapshots(previous, current, alpha);
+}
+
+void GLTFRenderer::applySnapshots(const FrameSnapshot& previous, const FrameSnapshot& current, float alpha) {
+    frameState.cameraPos = glm::mix(previous.cameraPos, current.cameraPos, alpha);
+    frameState.view = cameraViewMatrix(frameState.cameraPos, glm::mix(previous.yaw, current.yaw, alpha),
+                                       glm::mix(previous.pitch, current.pitch, alpha));
+    frameState.doorAngles = current.doorAngles;
+    for (size_t i = 0; i < current.doorAngles.size() && i < previous.doorAngles.size(); ++i) {
+        frameState.doorAngles[i] = glm::mix(previous.doorAngles[i], current.doorAngles[i], alpha);
+    }
+    frameState.doorsMoving = previous.doorsMoving || current.doorsMoving;
+
+    // Nós animados: setLocal (e o refit que ela causa) só quando a local desenhada muda
+    if (appliedPoseLocals.size() < current.poses.size()) appliedPoseLocals.resize(current.poses.size(), glm::mat4(0.0f));
+    for (size_t i = 0; i < current.poses.size(); ++i) {
+        const NodePose& pose = current.poses[i];
+        glm::mat4 local;
+        if (i < previous.poses.size() && previous.poses[i].node == pose.node && !samePose(previous.poses[i], pose)) {
+            const NodePose& from = previous.poses[i];
+            local = composeTransform(glm::mix(from.translation, pose.translation, alpha),
+                                     glm::slerp(from.rotation, pose.rotation, alpha),
+                                     glm::mix(from.scale, pose.scale, alpha));
+        } else {
+            local = composeTransform(pose.translation, pose.rotation, pose.scale);
+        }
+        if (local == appliedPoseLocals[i]) continue;
+        appliedPoseLocals[i] = local;
+        scene.setLocal(pose.node, local);
+    }
+}
+
+void GLTFRenderer::captureFrameState() {
+    // Nenhum passo de simulação ainda (ou câmera movida à mão): o frame desenha o estado como está
+    frameState.cameraPos = cameraPos;
+    frameState.view = view;
+    frameState.doorAngles.resize(doors.size());
+    frameState.doorsMoving = false;
+    for (size_t i = 0; i < doors.size(); ++i) {
+        frameState.doorAngles[i] = doors[i].angle;
+        if (doors[i].angle != doors[i].target) frameState.doorsMoving = true;
+    }
+}
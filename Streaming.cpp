@@ -0,0 +1,98 @@
+#include "GLTFRenderer.h"
+#include <chrono>
+
+LoadHandle GLTFRenderer::loadGLTFAsync(const std::string& filepath, const glm::mat4& baseTransform,
+                                       VertexFormat format) {
+    return queueAsyncLoad(filepath, baseTransform, false, glm::vec3(0.0f), format);
+}
+
+LoadHandle GLTFRenderer::loadGLTFAtAsync(const std::string& filepath, const glm::vec3& worldPos, VertexFormat format) {
+    return queueAsyncLoad(filepath, glm::mat4(1.0f), true, worldPos, format);
+}
+
+LoadHandle GLTFRenderer::queueAsyncLoad(const std::string& filepath, const glm::mat4& transform,
+                                        bool snapToGround, const glm::vec3& groundPos, VertexFormat format) {
+    AsyncLoadRequest request;
+    request.filepath = filepath;
+    request.transform = transform;
+    request.snapToGround = snapToGround;
+    request.groundPos = groundPos;
+
+    // Asset já enviado ou já sendo lido: só espera a vez de instanciar
+    if (assetCache.find(filepath) == assetCache.end()) {
+        auto inFlight = assetJobsInFlight.find(filepath);
+        if (inFlight != assetJobsInFlight.end()) {
+            request.job = inFlight->second;
+        } else {
+            auto job = std::make_shared<AsyncAssetJob>();
+            job->filepath = filepath;
+            job->format = format; // o primeiro pedido do arquivo decide o formato
+            // O sistema de jobs é criado aqui (thread do GL), nunca pelo job de fundo
+            jobSystem().runBackground([this, job] {
+                job->ok = stageModelAsset(job->filepath, job->format, job->staged);
+                job->done.store(true, std::memory_order_release);
+            });
+            assetJobsInFlight[filepath] = job;
+            request.job = job;
+        }
+    }
+    loadRequests.push_back(request);
+    return (LoadHandle)loadRequests.size() - 1;
+}
+
+LoadStatus GLTFRenderer::loadStatus(LoadHandle handle) const {
+    if (handle < 0 || handle >= (LoadHandle)loadRequests.size()) return LoadStatus::Failed;
+    return loadRequests[handle].status;
+}
+
+void GLTFRenderer::pumpAsyncLoads(double budgetMs) {
+    // Pedidos instanciados na ordem de chamada: móveis com Y ajustado ao chão esperam o prédio.
+    // Pelo menos um mesh é enviado por chamada, mesmo que sozinho estoure o orçamento
+    auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    while (nextLoadRequest < loadRequests.size()) {
+        AsyncLoadRequest& request = loadRequests[nextLoadRequest];
+        auto cached = assetCache.find(request.filepath);
+        if (cached == assetCache.end()) {
+            AsyncAssetJob& job = *request.job;
+            if (!job.done.load(std::memory_order_acquire)) break; // ainda lendo/decodificando
+            if (job.ok) {
+                while (job.nextMesh < job.staged.meshes.size()) {
+                    commitStagedMesh(job.staged.meshes[job.nextMesh++], job.asset);
+                    if (elapsedMs() >= budgetMs) break;
+                }
+                if (job.nextMesh < job.staged.meshes.size()) break; // continua no próximo frame
+                job.asset.nodes = std::move(job.staged.nodes);
+                job.asset.animations = std::move(job.staged.animations);
+                job.asset.rooms = std::move(job.staged.rooms);
+                job.asset.portals = std::move(job.staged.portals);
+                job.staged = StagedAsset(); // libera o mapeamento e as cópias na CPU
+            }
+            assetJobsInFlight.erase(request.filepath);
+            if (!job.ok || job.asset.meshIndices.empty()) {
+                std::cerr << "Falha no carregamento assíncrono de '" << request.filepath << "'" << std::endl;
+                request.status = LoadStatus::Failed;
+                request.job.reset();
+                nextLoadRequest++;
+                continue;
+            }
+            reportVertexMemory(request.filepath, job.asset);
+            cached = assetCache.emplace(request.filepath, std::move(job.asset)).first;
+        }
+
+        glm::mat4 transform = request.transform;
+        if (request.snapToGround) {
+            glm::vec3 pos = request.groundPos;
+            pos.y = groundHeightAt(pos);
+            transform = glm::translate(glm::mat4(1.0f), pos);
+            std::cout << "Colocando '" << request.filepath << "' em (" << pos.x << ", " << pos.y << ", " << pos.z << ")" << std::endl;
+        }
+        instantiateAsset(request.filepath, cached->second, transform);
+        request.status = LoadStatus::Ready;
+        request.job.reset();
+        nextLoadRequest++;
+        if (elapsedMs() >= budgetMs) break;
+    }
+}
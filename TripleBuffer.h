@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Buffer triplo sem travas entre um escritor e um leitor: cada um tem seu slot, o terceiro fica no meio.
+// publish() troca o slot escrito pelo do meio; acquire() pega o do meio se houver um mais novo. Nenhum dos
+// dois espera pelo outro, e um slot publicado não é tocado pelo escritor até voltar a ele por troca
+template <typename T>
+class TripleBuffer {
+public:
+    // Escritor: preencher tudo (o slot pode ter o conteúdo de duas publicações atrás) e publicar
+    T& writeBuffer() { return slots[writeIndex]; }
+    void publish() {
+        uint8_t previous = middle.exchange((uint8_t)(writeIndex | kFresh), std::memory_order_acq_rel);
+        writeIndex = previous & kIndexMask;
+    }
+
+    // Leitor: há publicação que ainda não foi pega?
+    bool fresh() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+    bool acquire() {
+        if (!fresh()) return false;
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & kIndexMask;
+        return true;
+    }
+    const T& readBuffer() const { return slots[readIndex]; }
+
+private:
+    static const uint8_t kIndexMask = 3;
+    static const uint8_t kFresh = 4;
+
+    T slots[3];
+    uint8_t writeIndex = 0;
+    uint8_t readIndex = 1;
+    std::atomic<uint8_t> middle{2};
+};
@@ -0,0 +1,102 @@
+#include "GLTFRenderer.h"
+#include <cstring>
+
+// Pontos de ligação dos blocos uniformes
+static const GLuint kFrameBlockBinding = 0;
+static const GLuint kDrawBlockBinding = 1;
+// Bytes sempre ligados para o bloco de draw (o bloco inteiro declarado no shader)
+static const size_t kDrawBlockBytes = kDrawBlockCapacity * sizeof(DrawDataGPU);
+// Capacidade inicial do anel (cresce se um frame não couber em um terço dele)
+static const size_t kDrawRingMinBytes = 256 * 1024;
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void GLTFRenderer::bindProgramBlocks(GLuint program) {
+    // Blocos ligados por índice (GLSL 330 não tem layout(binding)); o sampler usa sempre a unidade 0.
+    // Feito uma vez por programa, logo após o link
+    GLuint frameIndex = glGetUniformBlockIndex(program, "FrameBlock");
+    GLuint drawIndex = glGetUniformBlockIndex(program, "DrawBlock");
+    if (frameIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, frameIndex, kFrameBlockBinding);
+    if (drawIndex != GL_INVALID_INDEX) glUniformBlockBinding(program, drawIndex, kDrawBlockBinding);
+    GLint sampler = glGetUniformLocation(program, "ourTexture");
+    if (sampler >= 0) {
+        glUseProgram(program);
+        glUniform1i(sampler, 0);
+    }
+}
+
+void GLTFRenderer::initUniformBuffers() {
+    glGenBuffers(1, &frameUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_STREAM_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameBlockBinding, frameUBO);
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    drawRing.alignment = alignment > 0 ? (size_t)alignment : 256;
+    drawRing.capacity = kDrawRingMinBytes;
+    glGenBuffers(1, &drawRing.buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, drawRing.buffer);
+    glBufferData(GL_UNIFORM_BUFFER, drawRing.capacity, nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void GLTFRenderer::updateFrameUniforms() {
+    FrameUniforms frame;
+    frame.view = frameState.view;
+    frame.projection = projection;
+    frame.lightPos = glm::vec4(frameState.cameraPos + glm::vec3(0.0f, 2.0f, 0.0f), 1.0f);
+    frame.viewPos = glm::vec4(frameState.cameraPos, 1.0f);
+    frame.params = glm::vec4(chaoWorldTexScale, 0.0f, 0.0f, 0.0f);
+    // Pequeno e reescrito inteiro: orfanar com os dados novos
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), &frame, GL_STREAM_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+size_t GLTFRenderer::reserveDrawRecords(size_t& cursor, size_t count) const {
+    // Cada ligação começa alinhada a GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    size_t offset = alignUp(cursor, drawRing.alignment);
+    cursor = offset + count * sizeof(DrawDataGPU);
+    return offset;
+}
+
+DrawDataGPU* GLTFRenderer::mapDrawRecords(size_t bytes) {
+    // O último bind lê um bloco inteiro: reservar a cauda para não ler além do buffer
+    size_t needed = alignUp(bytes, drawRing.alignment) + kDrawBlockBytes;
+    glBindBuffer(GL_UNIFORM_BUFFER, drawRing.buffer);
+    if (needed * 3 > drawRing.capacity) {
+        drawRing.capacity = std::max(drawRing.capacity * 2, needed * 3);
+        drawRing.head = drawRing.capacity; // força o orfanamento abaixo
+    }
+    if (drawRing.head + needed > drawRing.capacity) {
+        // Orfanar: o driver entrega memória nova e a antiga continua viva para os frames em voo
+        glBufferData(GL_UNIFORM_BUFFER, drawRing.capacity, nullptr, GL_STREAM_DRAW);
+        drawRing.head = 0;
+    }
+    drawRing.frameBase = drawRing.head;
+    drawRing.head = alignUp(drawRing.head + needed, drawRing.alignment);
+    // Trecho nunca usado desde o último orfanamento: mapear sem sincronizar com a GPU
+    void* ptr = glMapBufferRange(GL_UNIFORM_BUFFER, drawRing.frameBase, needed,
+                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!ptr) {
+        std::cerr << "Falha ao mapear o anel de UBO (" << needed << " bytes)" << std::endl;
+    }
+    return (DrawDataGPU*)ptr;
+}
+
+void GLTFRenderer::bindDrawRecords(size_t offset) {
+    glBindBufferRange(GL_UNIFORM_BUFFER, kDrawBlockBinding, drawRing.buffer,
+                      drawRing.frameBase + offset, kDrawBlockBytes);
+}
+
+void GLTFRenderer::writeInstanceRecord(DrawDataGPU& out, int instanceIndex) const {
+    const Material& mat = materials[instances[instanceIndex].materialId];
+    // Mesh compacto: a desquantização das posições entra na matriz de modelo (a normal não é quantizada)
+    const Mesh& mesh = meshes[instances[instanceIndex].meshIndex];
+    out.model = mesh.compact ? worldTransforms[instanceIndex] * mesh.dequantize : worldTransforms[instanceIndex];
+    out.normalMatrix = normalTransforms[instanceIndex];
+    out.color = glm::vec4(mat.color, 1.0f);
+}
@@ -0,0 +1,283 @@
+#include "VertexBake.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define TJAL_BAKE_SSE 1
+#endif
+// AVX2 compilado por função (target) e escolhido em tempo de execução: o binário continua rodando sem AVX2
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define TJAL_BAKE_AVX2 1
+#endif
+
+// Floats por vértice intercalado
+static const size_t kVertexFloats = 8;
+// Piso do comprimento² na renormalização (normal nula continua nula, sem NaN)
+static const float kMinNormalLength2 = 1e-30f;
+
+// Coeficientes em ordem de coluna: p[c * 3 + r] = M[c][r] (c = 3 é a translação), n idem para a matriz normal
+struct BakeMatrices {
+    float p[12];
+    float n[9];
+};
+
+static BakeMatrices bakeMatrices(const glm::mat4& transform) {
+    BakeMatrices m;
+    glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+    for (int c = 0; c < 4; ++c) {
+        for (int r = 0; r < 3; ++r) m.p[c * 3 + r] = transform[c][r];
+    }
+    for (int c = 0; c < 3; ++c) {
+        for (int r = 0; r < 3; ++r) m.n[c * 3 + r] = normalMatrix[c][r];
+    }
+    return m;
+}
+
+static void bakeScalar(float* v, size_t count, const BakeMatrices& m, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    for (size_t i = 0; i < count; ++i, v += kVertexFloats) {
+        float x = v[0], y = v[1], z = v[2];
+        float nx = v[3], ny = v[4], nz = v[5];
+        for (int r = 0; r < 3; ++r) {
+            v[r] = m.p[r] * x + m.p[3 + r] * y + m.p[6 + r] * z + m.p[9 + r];
+            v[3 + r] = m.n[r] * nx + m.n[3 + r] * ny + m.n[6 + r] * nz;
+        }
+        float invLength = 1.0f / std::sqrt(std::max(v[3] * v[3] + v[4] * v[4] + v[5] * v[5], kMinNormalLength2));
+        v[3] *= invLength; v[4] *= invLength; v[5] *= invLength;
+        boundsMin = glm::min(boundsMin, glm::vec3(v[0], v[1], v[2]));
+        boundsMax = glm::max(boundsMax, glm::vec3(v[0], v[1], v[2]));
+    }
+}
+
+// Identidade (mesh que fica no espaço do próprio nó): só renormaliza as normais e mede a AABB
+static void normalizeScalar(float* v, size_t count, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    glm::vec3 mn = boundsMin, mx = boundsMax;
+    for (size_t i = 0; i < count; ++i, v += kVertexFloats) {
+        float invLength = 1.0f / std::sqrt(std::max(v[3] * v[3] + v[4] * v[4] + v[5] * v[5], kMinNormalLength2));
+        v[3] *= invLength; v[4] *= invLength; v[5] *= invLength;
+        mn = glm::min(mn, glm::vec3(v[0], v[1], v[2]));
+        mx = glm::max(mx, glm::vec3(v[0], v[1], v[2]));
+    }
+    boundsMin = mn;
+    boundsMax = mx;
+}
+
+#ifdef TJAL_BAKE_SSE
+static void bakeSSE2(float* v, size_t count, const BakeMatrices& m, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    // 4 vértices por vez: dois 4x4 transpostos dão x,y,z,nx e ny,nz,u,v em SoA
+    __m128 p[12], n[9];
+    for (int k = 0; k < 12; ++k) p[k] = _mm_set1_ps(m.p[k]);
+    for (int k = 0; k < 9; ++k) n[k] = _mm_set1_ps(m.n[k]);
+    __m128 minX = _mm_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    const __m128 minLength2 = _mm_set1_ps(kMinNormalLength2);
+
+    size_t blocks = count / 4;
+    for (size_t b = 0; b < blocks; ++b, v += 4 * kVertexFloats) {
+        __m128 x = _mm_loadu_ps(v), y = _mm_loadu_ps(v + 8), z = _mm_loadu_ps(v + 16), nx = _mm_loadu_ps(v + 24);
+        __m128 ny = _mm_loadu_ps(v + 4), nz = _mm_loadu_ps(v + 12), u = _mm_loadu_ps(v + 20), w = _mm_loadu_ps(v + 28);
+        _MM_TRANSPOSE4_PS(x, y, z, nx);
+        _MM_TRANSPOSE4_PS(ny, nz, u, w);
+
+        __m128 out[6];
+        for (int r = 0; r < 3; ++r) {
+            out[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[r], x), _mm_mul_ps(p[3 + r], y)),
+                                _mm_add_ps(_mm_mul_ps(p[6 + r], z), p[9 + r]));
+            out[3 + r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[r], nx), _mm_mul_ps(n[3 + r], ny)), _mm_mul_ps(n[6 + r], nz));
+        }
+        __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(out[3], out[3]), _mm_mul_ps(out[4], out[4])), _mm_mul_ps(out[5], out[5]));
+        __m128 length = _mm_sqrt_ps(_mm_max_ps(length2, minLength2));
+        for (int r = 3; r < 6; ++r) out[r] = _mm_div_ps(out[r], length);
+
+        minX = _mm_min_ps(minX, out[0]); maxX = _mm_max_ps(maxX, out[0]);
+        minY = _mm_min_ps(minY, out[1]); maxY = _mm_max_ps(maxY, out[1]);
+        minZ = _mm_min_ps(minZ, out[2]); maxZ = _mm_max_ps(maxZ, out[2]);
+
+        _MM_TRANSPOSE4_PS(out[0], out[1], out[2], out[3]);
+        _MM_TRANSPOSE4_PS(out[4], out[5], u, w);
+        _mm_storeu_ps(v, out[0]);      _mm_storeu_ps(v + 4, out[4]);
+        _mm_storeu_ps(v + 8, out[1]);  _mm_storeu_ps(v + 12, out[5]);
+        _mm_storeu_ps(v + 16, out[2]); _mm_storeu_ps(v + 20, u);
+        _mm_storeu_ps(v + 24, out[3]); _mm_storeu_ps(v + 28, w);
+    }
+
+    alignas(16) float lanes[6][4];
+    _mm_store_ps(lanes[0], minX); _mm_store_ps(lanes[1], minY); _mm_store_ps(lanes[2], minZ);
+    _mm_store_ps(lanes[3], maxX); _mm_store_ps(lanes[4], maxY); _mm_store_ps(lanes[5], maxZ);
+    for (int k = 0; k < 4; ++k) {
+        boundsMin = glm::min(boundsMin, glm::vec3(lanes[0][k], lanes[1][k], lanes[2][k]));
+        boundsMax = glm::max(boundsMax, glm::vec3(lanes[3][k], lanes[4][k], lanes[5][k]));
+    }
+    bakeScalar(v, count - blocks * 4, m, boundsMin, boundsMax);
+}
+#endif
+
+#ifdef TJAL_BAKE_AVX2
+// 8x8 in-place: r[k] = vértice k -> r[k] = componente k dos 8 vértices (e vice-versa)
+__attribute__((target("avx2,fma")))
+static inline void transpose8(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]), t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]), t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)), s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)), s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0)), s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0)), s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20); r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20); r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20); r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20); r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+__attribute__((target("avx2,fma")))
+static void bakeAVX2(float* v, size_t count, const BakeMatrices& m, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    // 8 vértices = 8 registros de 8 floats: transpor, calcular em SoA com FMA, transpor de volta
+    __m256 p[12], n[9];
+    for (int k = 0; k < 12; ++k) p[k] = _mm256_set1_ps(m.p[k]);
+    for (int k = 0; k < 9; ++k) n[k] = _mm256_set1_ps(m.n[k]);
+    __m256 minX = _mm256_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m256 maxX = _mm256_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    const __m256 minLength2 = _mm256_set1_ps(kMinNormalLength2);
+
+    size_t blocks = count / 8;
+    for (size_t b = 0; b < blocks; ++b, v += 8 * kVertexFloats) {
+        __m256 r[8];
+        for (int k = 0; k < 8; ++k) r[k] = _mm256_loadu_ps(v + k * kVertexFloats);
+        transpose8(r);
+
+        __m256 out[6];
+        for (int c = 0; c < 3; ++c) {
+            out[c] = _mm256_fmadd_ps(p[c], r[0], _mm256_fmadd_ps(p[3 + c], r[1], _mm256_fmadd_ps(p[6 + c], r[2], p[9 + c])));
+            out[3 + c] = _mm256_fmadd_ps(n[c], r[3], _mm256_fmadd_ps(n[3 + c], r[4], _mm256_mul_ps(n[6 + c], r[5])));
+        }
+        __m256 length2 = _mm256_fmadd_ps(out[3], out[3], _mm256_fmadd_ps(out[4], out[4], _mm256_mul_ps(out[5], out[5])));
+        __m256 length = _mm256_sqrt_ps(_mm256_max_ps(length2, minLength2));
+        for (int c = 0; c < 6; ++c) r[c] = c < 3 ? out[c] : _mm256_div_ps(out[c], length);
+
+        minX = _mm256_min_ps(minX, r[0]); maxX = _mm256_max_ps(maxX, r[0]);
+        minY = _mm256_min_ps(minY, r[1]); maxY = _mm256_max_ps(maxY, r[1]);
+        minZ = _mm256_min_ps(minZ, r[2]); maxZ = _mm256_max_ps(maxZ, r[2]);
+
+        transpose8(r);
+        for (int k = 0; k < 8; ++k) _mm256_storeu_ps(v + k * kVertexFloats, r[k]);
+    }
+
+    alignas(32) float lanes[6][8];
+    _mm256_store_ps(lanes[0], minX); _mm256_store_ps(lanes[1], minY); _mm256_store_ps(lanes[2], minZ);
+    _mm256_store_ps(lanes[3], maxX); _mm256_store_ps(lanes[4], maxY); _mm256_store_ps(lanes[5], maxZ);
+    for (int k = 0; k < 8; ++k) {
+        boundsMin = glm::min(boundsMin, glm::vec3(lanes[0][k], lanes[1][k], lanes[2][k]));
+        boundsMax = glm::max(boundsMax, glm::vec3(lanes[3][k], lanes[4][k], lanes[5][k]));
+    }
+    bakeScalar(v, count - blocks * 8, m, boundsMin, boundsMax);
+}
+#endif
+
+bool vertexBakeKernelSupported(VertexBakeKernel kernel) {
+    switch (kernel) {
+#ifdef TJAL_BAKE_AVX2
+        case BAKE_AVX2: {
+            static const bool avx2 = [] {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            }();
+            return avx2;
+        }
+#endif
+#ifdef TJAL_BAKE_SSE
+        case BAKE_SSE2: return true;
+#endif
+        case BAKE_SCALAR: return true;
+        default: return false;
+    }
+}
+
+VertexBakeKernel bestVertexBakeKernel() {
+#ifdef TJAL_BAKE_SSE
+    return BAKE_SSE2;
+#else
+    return BAKE_SCALAR;
+#endif
+}
+
+const char* vertexBakeKernelName(VertexBakeKernel kernel) {
+    switch (kernel) {
+        case BAKE_AVX2: return "AVX2";
+        case BAKE_SSE2: return "SSE2";
+        default: return "escalar";
+    }
+}
+
+#ifdef TJAL_BAKE_SSE
+static void normalizeSSE2(float* v, size_t count, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    // Mesmo layout do bakeSSE2, sem a transformação: só a metade das transposições (posição e normal)
+    __m128 minX = _mm_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX, maxZ = maxX;
+    const __m128 minLength2 = _mm_set1_ps(kMinNormalLength2);
+
+    size_t blocks = count / 4;
+    for (size_t b = 0; b < blocks; ++b, v += 4 * kVertexFloats) {
+        __m128 x = _mm_loadu_ps(v), y = _mm_loadu_ps(v + 8), z = _mm_loadu_ps(v + 16), nx = _mm_loadu_ps(v + 24);
+        __m128 ny = _mm_loadu_ps(v + 4), nz = _mm_loadu_ps(v + 12), u = _mm_loadu_ps(v + 20), w = _mm_loadu_ps(v + 28);
+        _MM_TRANSPOSE4_PS(x, y, z, nx);
+        _MM_TRANSPOSE4_PS(ny, nz, u, w);
+        __m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+        __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_max_ps(length2, minLength2)));
+        nx = _mm_mul_ps(nx, invLength); ny = _mm_mul_ps(ny, invLength); nz = _mm_mul_ps(nz, invLength);
+
+        minX = _mm_min_ps(minX, x); maxX = _mm_max_ps(maxX, x);
+        minY = _mm_min_ps(minY, y); maxY = _mm_max_ps(maxY, y);
+        minZ = _mm_min_ps(minZ, z); maxZ = _mm_max_ps(maxZ, z);
+
+        _MM_TRANSPOSE4_PS(x, y, z, nx);
+        _MM_TRANSPOSE4_PS(ny, nz, u, w);
+        _mm_storeu_ps(v, x);       _mm_storeu_ps(v + 4, ny);
+        _mm_storeu_ps(v + 8, y);   _mm_storeu_ps(v + 12, nz);
+        _mm_storeu_ps(v + 16, z);  _mm_storeu_ps(v + 20, u);
+        _mm_storeu_ps(v + 24, nx); _mm_storeu_ps(v + 28, w);
+    }
+
+    alignas(16) float lanes[6][4];
+    _mm_store_ps(lanes[0], minX); _mm_store_ps(lanes[1], minY); _mm_store_ps(lanes[2], minZ);
+    _mm_store_ps(lanes[3], maxX); _mm_store_ps(lanes[4], maxY); _mm_store_ps(lanes[5], maxZ);
+    for (int k = 0; k < 4; ++k) {
+        boundsMin = glm::min(boundsMin, glm::vec3(lanes[0][k], lanes[1][k], lanes[2][k]));
+        boundsMax = glm::max(boundsMax, glm::vec3(lanes[3][k], lanes[4][k], lanes[5][k]));
+    }
+    normalizeScalar(v, count - blocks * 4, boundsMin, boundsMax);
+}
+#endif
+
+void bakeVerticesWith(VertexBakeKernel kernel, float* vertices, size_t vertexCount, const glm::mat4& transform,
+                      glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    BakeMatrices m = bakeMatrices(transform);
+#ifdef TJAL_BAKE_AVX2
+    if (kernel == BAKE_AVX2 && vertexBakeKernelSupported(BAKE_AVX2)) {
+        bakeAVX2(vertices, vertexCount, m, boundsMin, boundsMax);
+        return;
+    }
+#endif
+#ifdef TJAL_BAKE_SSE
+    if (kernel != BAKE_SCALAR) {
+        bakeSSE2(vertices, vertexCount, m, boundsMin, boundsMax);
+        return;
+    }
+#endif
+    bakeScalar(vertices, vertexCount, m, boundsMin, boundsMax);
+}
+
+void bakeVertices(float* vertices, size_t vertexCount, const glm::mat4& transform,
+                  glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    if (transform == glm::mat4(1.0f)) {
+#ifdef TJAL_BAKE_SSE
+        normalizeSSE2(vertices, vertexCount, boundsMin, boundsMax);
+#else
+        normalizeScalar(vertices, vertexCount, boundsMin, boundsMax);
+#endif
+        return;
+    }
+    bakeVerticesWith(bestVertexBakeKernel(), vertices, vertexCount, transform, boundsMin, boundsMax);
+}
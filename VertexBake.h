@@ -0,0 +1,27 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// "Cozimento" dos vértices intercalados [pos3 normal3 uv2] de um mesh: posições pela matriz do nó,
+// normais pela matriz normal (inversa transposta, renormalizadas) e AABB das posições, em uma passada.
+// Sem dependência de OpenGL (usado também pelo benchmark em bench/)
+enum VertexBakeKernel {
+    BAKE_SCALAR = 0,
+    BAKE_SSE2,  // 4 vértices por iteração
+    BAKE_AVX2   // 8 vértices por iteração (AVX2 + FMA)
+};
+
+// Kernel do cozimento em produção: SSE2 mesmo com AVX2 presente (no `make bench` as transposições 8x8 do
+// AVX2 custam mais do que a largura dobrada ganha)
+VertexBakeKernel bestVertexBakeKernel();
+// A CPU atual executa o kernel? (detectado uma vez)
+bool vertexBakeKernelSupported(VertexBakeKernel kernel);
+const char* vertexBakeKernelName(VertexBakeKernel kernel);
+
+// Transforma no lugar e expande boundsMin/boundsMax com as posições transformadas. Com a identidade, só
+// renormaliza as normais e mede a AABB (sem a transformação 4x4)
+void bakeVertices(float* vertices, size_t vertexCount, const glm::mat4& transform,
+                  glm::vec3& boundsMin, glm::vec3& boundsMax);
+void bakeVerticesWith(VertexBakeKernel kernel, float* vertices, size_t vertexCount, const glm::mat4& transform,
+                      glm::vec3& boundsMin, glm::vec3& boundsMax);
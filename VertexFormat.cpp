@@ -0,0 +1,79 @@
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const float kQuantizedMax = 65535.0f;
+// 10 bits com sinal: [-511, 511]
+static const float kPackedNormalMax = 511.0f;
+
+size_t vertexFormatBytes(VertexFormat format) {
+    return format == VertexFormat::Compact ? sizeof(CompactVertex) : 8 * sizeof(float);
+}
+
+static glm::vec3 quantizationExtent(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    glm::vec3 extent = boundsMax - boundsMin;
+    for (int c = 0; c < 3; ++c) {
+        if (!(extent[c] > 0.0f)) extent[c] = 1.0f;
+    }
+    return extent;
+}
+
+// float → half (IEEE 754 binary16) com arredondamento ao mais próximo; fora da faixa vira infinito
+static uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    uint32_t exponent = (bits >> 23) & 0xFFu;
+    uint32_t mantissa = bits & 0x7FFFFFu;
+    if (exponent == 0xFFu) return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u)); // inf/NaN
+    int halfExponent = (int)exponent - 127 + 15;
+    if (halfExponent >= 31) return (uint16_t)(sign | 0x7C00u);
+    if (halfExponent <= 0) {
+        // Subnormal (ou zero) em half
+        if (halfExponent < -10) return (uint16_t)sign;
+        mantissa |= 0x800000u;
+        uint32_t shift = (uint32_t)(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1u), halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1u))) half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) half++; // pode subir o expoente (correto)
+    return (uint16_t)(sign | half);
+}
+
+static uint32_t packSignedNormalized10(float value) {
+    float clamped = std::min(std::max(value, -1.0f), 1.0f);
+    int q = (int)std::lround(clamped * kPackedNormalMax);
+    return (uint32_t)q & 0x3FFu;
+}
+
+void packCompactVertices(const float* vertices, size_t vertexCount,
+                         const glm::vec3& boundsMin, const glm::vec3& boundsMax, CompactVertex* out) {
+    glm::vec3 scale = kQuantizedMax / quantizationExtent(boundsMin, boundsMax);
+    for (size_t i = 0; i < vertexCount; ++i, vertices += 8, ++out) {
+        for (int c = 0; c < 3; ++c) {
+            float q = (vertices[c] - boundsMin[c]) * scale[c];
+            out->position[c] = (uint16_t)std::lround(std::min(std::max(q, 0.0f), kQuantizedMax));
+        }
+        out->position[3] = 0;
+        out->normal = packSignedNormalized10(vertices[3]) |
+                      (packSignedNormalized10(vertices[4]) << 10) |
+                      (packSignedNormalized10(vertices[5]) << 20);
+        out->uv[0] = floatToHalf(vertices[6]);
+        out->uv[1] = floatToHalf(vertices[7]);
+    }
+}
+
+glm::mat4 compactDequantizeMatrix(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    glm::vec3 extent = quantizationExtent(boundsMin, boundsMax);
+    glm::mat4 m(1.0f);
+    m[0][0] = extent.x;
+    m[1][1] = extent.y;
+    m[2][2] = extent.z;
+    m[3] = glm::vec4(boundsMin, 1.0f);
+    return m;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Layout dos vértices na GPU, escolhido por carregamento (cada layout tem sua própria arena/VAO)
+enum class VertexFormat {
+    Full,    // [pos3 normal3 uv2] em float: 32 bytes
+    Compact  // posição 16 bits quantizada na AABB do mesh, normal 2_10_10_10, UV half: 16 bytes
+};
+
+// Vértice compacto. A posição chega ao shader em [0,1]³ (UNSIGNED_SHORT normalizado) e volta ao espaço
+// do asset pela matriz de desquantização do mesh, já multiplicada na matriz de modelo do draw
+struct CompactVertex {
+    uint16_t position[4]; // x, y, z; w = 0 (mantém normal/UV alinhados em 4 bytes)
+    uint32_t normal;      // GL_INT_2_10_10_10_REV normalizado (w = 0)
+    uint16_t uv[2];       // half float
+};
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex deve ter 16 bytes (atributos do VAO compacto)");
+
+// Bytes por vértice de cada layout
+size_t vertexFormatBytes(VertexFormat format);
+
+// Converte vértices intercalados [pos3 normal3 uv2] já cozidos; posições quantizadas em boundsMin..boundsMax
+void packCompactVertices(const float* vertices, size_t vertexCount,
+                         const glm::vec3& boundsMin, const glm::vec3& boundsMax, CompactVertex* out);
+
+// [0,1]³ → caixa boundsMin..boundsMax (eixos degenerados usam escala 1)
+glm::mat4 compactDequantizeMatrix(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
@@ -0,0 +1,160 @@
+// Escalabilidade do sistema de jobs (make bench-jobs)
+// Mesmas cargas com 1..N threads: decode de meshes (solda + ordem de cache + LODs, um mesh por job, como no
+// loadGLTF), culling de AABBs em faixas finas (como cullInstances/buildRenderQueue) e o custo por job de
+// jobs vazios e de uma cadeia de continuações (runAfter)
+#include "JobSystem.h"
+#include "MeshOptimize.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Box {
+    float min[3], max[3];
+};
+
+// Grade ondulada side x side com vértices [pos3 normal3 uv2] duplicados por triângulo (a solda tem trabalho)
+static void makeGrid(int side, float phase, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+    vertices.clear();
+    indices.clear();
+    auto push = [&](int x, int z) {
+        float fx = (float)x / side, fz = (float)z / side;
+        float y = 0.1f * std::sin(fx * 12.0f + phase) * std::cos(fz * 9.0f);
+        float v[8] = { fx, y, fz, 0.0f, 1.0f, 0.0f, fx, fz };
+        indices.push_back((unsigned int)(vertices.size() / 8));
+        vertices.insert(vertices.end(), v, v + 8);
+    };
+    for (int z = 0; z < side; ++z) {
+        for (int x = 0; x < side; ++x) {
+            push(x, z); push(x + 1, z); push(x, z + 1);
+            push(x + 1, z); push(x + 1, z + 1); push(x, z + 1);
+        }
+    }
+}
+
+static std::vector<Box> makeBoxes(size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f), size(0.1f, 2.0f);
+    std::vector<Box> boxes(count);
+    for (Box& b : boxes) {
+        for (int c = 0; c < 3; ++c) {
+            b.min[c] = pos(rng);
+            b.max[c] = b.min[c] + size(rng);
+        }
+    }
+    return boxes;
+}
+
+// Teste do canto positivo contra 6 planos (nx, ny, nz, d), igual ao classifyAABB sem SIMD
+static bool boxVisible(const Box& b, const float (*planes)[4]) {
+    for (int p = 0; p < 6; ++p) {
+        const float* n = planes[p];
+        float x = n[0] >= 0.0f ? b.max[0] : b.min[0];
+        float y = n[1] >= 0.0f ? b.max[1] : b.min[1];
+        float z = n[2] >= 0.0f ? b.max[2] : b.min[2];
+        if (n[0] * x + n[1] * y + n[2] * z + n[3] < 0.0f) return false;
+    }
+    return true;
+}
+
+template <typename F>
+static double bestOf(int runs, F&& fn) {
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    unsigned maxThreads = argc > 1 ? (unsigned)std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    const int runs = 5;
+    const int meshCount = 64, gridSide = 48;
+    const size_t boxCount = 1 << 20, cullGrain = 4096;
+    const int emptyJobs = 100000, chainLength = 20000;
+    const float planes[6][4] = {
+        { 1, 0, 0, 60 }, { -1, 0, 0, 60 }, { 0, 1, 0, 60 }, { 0, -1, 0, 60 }, { 0, 0, 1, 60 }, { 0, 0, -1, 60 },
+    };
+
+    std::vector<std::vector<float>> sourceVertices(meshCount);
+    std::vector<std::vector<unsigned int>> sourceIndices(meshCount);
+    for (int m = 0; m < meshCount; ++m) makeGrid(gridSide, (float)m, sourceVertices[m], sourceIndices[m]);
+    std::vector<Box> boxes = makeBoxes(boxCount);
+
+    std::printf("Sistema de jobs, 1..%u threads (melhor de %d)\n", maxThreads, runs);
+    std::printf("  decode: %d meshes de %d triângulos; culling: %zu AABBs em faixas de %zu\n", meshCount,
+                2 * gridSide * gridSide, boxCount, cullGrain);
+    std::printf("  %7s %12s %8s %12s %8s %14s %14s\n", "threads", "decode ms", "ganho", "culling ms", "ganho",
+                "job vazio µs", "continuação µs");
+
+    double decodeBase = 0.0, cullBase = 0.0;
+    size_t expectedVisible = 0;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        // A thread que espera também executa jobs: threads - 1 workers
+        JobSystem jobs((int)threads - 1);
+
+        std::vector<std::vector<float>> vertices(meshCount);
+        std::vector<std::vector<unsigned int>> indices(meshCount);
+        double decodeMs = 1e30;
+        for (int r = 0; r < runs; ++r) {
+            vertices = sourceVertices;
+            indices = sourceIndices;
+            decodeMs = std::min(decodeMs, bestOf(1, [&] {
+                jobs.parallelFor(meshCount, [&](size_t m) {
+                    MeshOptimizeStats stats;
+                    MeshLOD lods[kMaxMeshLods];
+                    optimizeMesh(vertices[m], indices[m], stats);
+                    buildMeshLods(vertices[m], indices[m], lods);
+                });
+            }));
+        }
+
+        size_t chunks = (boxCount + cullGrain - 1) / cullGrain;
+        std::vector<size_t> partial(chunks);
+        size_t visible = 0;
+        double cullMs = bestOf(runs, [&] {
+            jobs.parallelFor(boxCount, cullGrain, [&](size_t begin, size_t end) {
+                size_t n = 0;
+                for (size_t i = begin; i < end; ++i) n += boxVisible(boxes[i], planes) ? 1 : 0;
+                partial[begin / cullGrain] = n;
+            });
+            visible = 0;
+            for (size_t n : partial) visible += n;
+        });
+
+        std::atomic<int> ran{0};
+        double emptyMs = bestOf(runs, [&] {
+            JobCounter counter;
+            for (int j = 0; j < emptyJobs; ++j) jobs.run([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            jobs.wait(counter);
+        });
+
+        // Cada elo só é agendado quando o anterior termina (nenhum paralelismo possível: mede a latência)
+        double chainMs = bestOf(runs, [&] {
+            std::vector<std::unique_ptr<JobCounter>> links;
+            links.reserve(chainLength);
+            for (int j = 0; j < chainLength; ++j) links.emplace_back(new JobCounter());
+            jobs.run([] {}, links[0].get());
+            for (int j = 1; j < chainLength; ++j) jobs.runAfter(*links[j - 1], [] {}, links[j].get());
+            jobs.wait(*links.back());
+        });
+
+        if (threads == 1) {
+            decodeBase = decodeMs;
+            cullBase = cullMs;
+            expectedVisible = visible;
+        }
+        std::printf("  %7u %12.2f %7.2fx %12.2f %7.2fx %14.3f %14.3f%s\n", threads, decodeMs, decodeBase / decodeMs,
+                    cullMs, cullBase / cullMs, emptyMs * 1000.0 / emptyJobs, chainMs * 1000.0 / chainLength,
+                    visible == expectedVisible ? "" : "  CONTAGEM DIFERENTE");
+    }
+    return 0;
+}
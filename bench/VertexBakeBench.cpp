@@ -0,0 +1,123 @@
+// Microbenchmark do cozimento de vértices (make bench)
+// Compara o caminho antigo do loadPrimitive (glm escalar, vetor temporário, min/max em duas passadas,
+// normais sem transformar) com os kernels de VertexBake.cpp em meshes de vários milhões de vértices
+#include "VertexBake.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+static std::vector<float> makeVertices(size_t count) {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f), unit(-1.0f, 1.0f);
+    std::vector<float> v(count * 8);
+    for (size_t i = 0; i < count; ++i) {
+        float* o = &v[i * 8];
+        o[0] = pos(rng); o[1] = pos(rng); o[2] = pos(rng);
+        glm::vec3 n = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(0.0f, 0.01f, 0.0f));
+        o[3] = n.x; o[4] = n.y; o[5] = n.z;
+        o[6] = unit(rng); o[7] = unit(rng);
+    }
+    return v;
+}
+
+// Reprodução do caminho anterior: posições separadas -> min/max bruto -> transformadas em um vetor
+// temporário -> min/max de novo -> intercalação
+static void legacyBake(const std::vector<float>& positions, const std::vector<float>& normals,
+                       const std::vector<float>& uvs, const glm::mat4& transform,
+                       std::vector<float>& out, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    size_t count = positions.size() / 3;
+    glm::vec3 rawMin(FLT_MAX), rawMax(-FLT_MAX);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 p(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+        rawMin = glm::min(rawMin, p);
+        rawMax = glm::max(rawMax, p);
+    }
+    std::vector<glm::vec3> transformed;
+    transformed.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec4 p = transform * glm::vec4(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2], 1.0f);
+        transformed.push_back(glm::vec3(p));
+    }
+    out.clear();
+    out.reserve(count * 8);
+    for (size_t i = 0; i < count; ++i) {
+        out.push_back(transformed[i].x); out.push_back(transformed[i].y); out.push_back(transformed[i].z);
+        out.push_back(normals[i * 3]); out.push_back(normals[i * 3 + 1]); out.push_back(normals[i * 3 + 2]);
+        out.push_back(uvs[i * 2]); out.push_back(uvs[i * 2 + 1]);
+    }
+    for (const auto& p : transformed) {
+        boundsMin = glm::min(boundsMin, p);
+        boundsMax = glm::max(boundsMax, p);
+    }
+}
+
+template <typename F>
+static double bestOf(int runs, F&& fn) {
+    double best = 1e30;
+    for (int r = 0; r < runs; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? (size_t)std::atoll(argv[1]) : 4000000;
+    const int runs = 5;
+    glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(3.0f, -1.0f, 7.5f)) *
+                          glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0.3f, 1.0f, 0.1f)) *
+                          glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 0.5f));
+    std::vector<float> source = makeVertices(count);
+
+    std::printf("Cozimento de %zu vértices (melhor de %d), kernel em uso no loader: %s\n", count, runs,
+                vertexBakeKernelName(bestVertexBakeKernel()));
+
+    // Entrada do caminho antigo: atributos em vetores separados, como saíam de loadAccessorData
+    std::vector<float> positions(count * 3), normals(count * 3), uvs(count * 2), legacyOut;
+    for (size_t i = 0; i < count; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            positions[i * 3 + c] = source[i * 8 + c];
+            normals[i * 3 + c] = source[i * 8 + 3 + c];
+        }
+        uvs[i * 2] = source[i * 8 + 6];
+        uvs[i * 2 + 1] = source[i * 8 + 7];
+    }
+    glm::vec3 legacyMin(FLT_MAX), legacyMax(-FLT_MAX);
+    double legacyMs = bestOf(runs, [&] { legacyBake(positions, normals, uvs, transform, legacyOut, legacyMin, legacyMax); });
+    std::printf("  %-22s %8.2f ms  %7.1f Mvért/s\n", "anterior (glm escalar)", legacyMs, count / legacyMs / 1000.0);
+
+    std::vector<float> reference = source;
+    glm::vec3 refMin(FLT_MAX), refMax(-FLT_MAX);
+    bakeVerticesWith(BAKE_SCALAR, reference.data(), count, transform, refMin, refMax);
+
+    const VertexBakeKernel kernels[] = { BAKE_SCALAR, BAKE_SSE2, BAKE_AVX2 };
+    std::vector<float> work(source.size());
+    for (VertexBakeKernel kernel : kernels) {
+        if (!vertexBakeKernelSupported(kernel)) continue;
+        glm::vec3 mn(FLT_MAX), mx(-FLT_MAX);
+        // A cópia da entrada fica fora da medição (o kernel trabalha no lugar)
+        double ms = 1e30;
+        for (int r = 0; r < runs; ++r) {
+            work = source;
+            mn = glm::vec3(FLT_MAX);
+            mx = glm::vec3(-FLT_MAX);
+            ms = std::min(ms, bestOf(1, [&] { bakeVerticesWith(kernel, work.data(), count, transform, mn, mx); }));
+        }
+        float maxError = 0.0f;
+        for (size_t i = 0; i < work.size(); ++i) maxError = std::max(maxError, std::abs(work[i] - reference[i]));
+        bool boundsOk = true;
+        for (int c = 0; c < 3; ++c) {
+            boundsOk = boundsOk && std::abs(mn[c] - refMin[c]) <= 1e-3f && std::abs(mx[c] - refMax[c]) <= 1e-3f;
+        }
+        std::printf("  %-22s %8.2f ms  %7.1f Mvért/s  %5.2fx  erro máx %.2e%s\n", vertexBakeKernelName(kernel), ms,
+                    count / ms / 1000.0, legacyMs / ms, maxError, boundsOk ? "" : "  AABB DIFERENTE");
+    }
+    return 0;
+}
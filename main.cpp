@@ -1,5 +1,6 @@
 // Apenas inclui a API do renderizador já separada
 #include "GLTFRenderer.h"
+#include <cstdio>
 
 GLTFRenderer* g_renderer = nullptr;
 
@@ -13,6 +14,18 @@ void errorCallback(int error, const char* description) {
     std::cerr << "❌ Erro GLFW " << error << ": " << description << std::endl;
 }
 
+// Teclas mantidas da simulação: andar (W S A D), subir/descer (Shift/Espaço), girar (setas)
+static SimInput readSimInput(GLFWwindow* window) {
+    static const int moveKeys[4] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_A, GLFW_KEY_D };
+    static const int verticalKeys[2] = { GLFW_KEY_LEFT_SHIFT, GLFW_KEY_SPACE };
+    static const int rotateKeys[4] = { GLFW_KEY_UP, GLFW_KEY_DOWN, GLFW_KEY_LEFT, GLFW_KEY_RIGHT };
+    SimInput input;
+    for (int i = 0; i < 4; ++i) input.move[i] = glfwGetKey(window, moveKeys[i]) == GLFW_PRESS;
+    for (int i = 0; i < 2; ++i) input.vertical[i] = glfwGetKey(window, verticalKeys[i]) == GLFW_PRESS;
+    for (int i = 0; i < 4; ++i) input.rotate[i] = glfwGetKey(window, rotateKeys[i]) == GLFW_PRESS;
+    return input;
+}
+
 // Função para verificar erros OpenGL
 void checkOpenGLError(const std::string& operation) {
     GLenum error = glGetError();
@@ -21,7 +34,26 @@ void checkOpenGLError(const std::string& operation) {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // --cook <arquivos...>: gera os .tjmesh e sai (sem janela nem contexto OpenGL)
+    if (argc > 1 && std::string(argv[1]) == "--cook") {
+        GLTFRenderer cooker;
+        int failures = 0;
+        for (int i = 2; i < argc; ++i) {
+            if (!cooker.cookModel(argv[i])) failures++;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    // --compact: modelos no formato de vértice compacto (16 B/vértice em vez de 32)
+    // --sim-thread: simulação (câmera, portas, animações) em thread própria, com tick fixo
+    VertexFormat vertexFormat = VertexFormat::Full;
+    bool simulationThread = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--compact") vertexFormat = VertexFormat::Compact;
+        if (std::string(argv[i]) == "--sim-thread") simulationThread = true;
+    }
+
     if (!glfwInit()) {
         std::cerr << "❌ Falha ao inicializar GLFW" << std::endl;
         return -1;
@@ -57,6 +89,7 @@ int main() {
     g_renderer = &renderer;
 
     if (!renderer.initOpenGL()) return -1;
+    if (simulationThread) renderer.startSimulationThread();
 
     // Tenta carregar do novo diretório models/ com variações de nome
     const char* candidates[] = {
@@ -65,42 +98,49 @@ int main() {
         "TJAL.gltf",
         "tjal.gltf"
     };
-    bool loaded = false;
+    const char* buildingPath = nullptr;
     for (const char* path : candidates) {
-        if (renderer.loadGLTF(path)) { loaded = true; break; }
+        if (std::ifstream(path).good()) { buildingPath = path; break; }
     }
-    if (!loaded) {
+    if (!buildingPath) {
         std::cerr << "Falha ao carregar o modelo GLTF (tente colocar TJAL.gltf em models/)." << std::endl;
         glfwTerminate();
         return -1;
     }
 
-    // Posicionar o usuário em frente à escada a 3.0 unidades de distância
-    renderer.spawnInFrontOf("escada", 3.0f);
+    // Tudo é carregado em segundo plano: a janela abre na hora e cada objeto aparece quando fica pronto.
+    // O prédio vem primeiro (os móveis ajustam Y ao chão dele ao serem instanciados)
+    double loadStart = glfwGetTime();
+    LoadHandle building = renderer.loadGLTFAsync(buildingPath, glm::mat4(1.0f), vertexFormat);
+    bool spawned = false;
 
     // Carregar outros móveis com posições XZ explícitas (Y ajustado ao chão automaticamente)
-    renderer.loadGLTFAt("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 8.0f));
-    renderer.loadGLTFAt("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 10.0f));
-    renderer.loadGLTFAt("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 12.0f));
+    renderer.loadGLTFAtAsync("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 8.0f), vertexFormat);
+    renderer.loadGLTFAtAsync("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 10.0f), vertexFormat);
+    renderer.loadGLTFAtAsync("models/sofa.gltf",    glm::vec3(-4.0f, 0.0f, 12.0f), vertexFormat);
     
     // Tapete no centro, bem no nível do chão
-    renderer.loadGLTFAt("models/tapete.gltf",  glm::vec3(-2.0f, 0.0f, -5.5f));
+    renderer.loadGLTFAtAsync("models/tapete.gltf",  glm::vec3(-2.0f, 0.0f, -5.5f), vertexFormat);
     
-    renderer.loadGLTFAt("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 9.0f));
-    renderer.loadGLTFAt("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 11.0f));
-    renderer.loadGLTFAt("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 13.0f));
+    renderer.loadGLTFAtAsync("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 9.0f), vertexFormat);
+    renderer.loadGLTFAtAsync("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 11.0f), vertexFormat);
+    renderer.loadGLTFAtAsync("models/cadeira3.gltf",glm::vec3(-1.0f, 0.0f, 13.0f), vertexFormat);
     
     // Projetor no teto, posicionado no centro da sala - usando matriz para evitar ajuste automático do Y
     glm::mat4 projetorTransform = glm::translate(glm::mat4(1.0f), glm::vec3(-2.0f, 5.5f, -12.5f));
-    renderer.loadGLTF("models/projetor.gltf", projetorTransform);
-
-
+    renderer.loadGLTFAsync("models/projetor.gltf", projetorTransform, vertexFormat);
 
+    // Tempo máximo por frame gasto enviando meshes prontos à GPU
+    const double kUploadBudgetMs = 4.0;
 
     double lastTime = glfwGetTime();
     bool tabPressed = false, pPressed = false, tPressed = false, ePressed = false;
-    bool f11Pressed = false;
+    bool f11Pressed = false, cPressed = false, rPressed = false, oPressed = false, lPressed = false;
+    bool kPressed = false;
+    bool nPressed = false;
     int frameCount = 0;
+    double lastStatsTime = lastTime;
+    int statsFrames = 0;
 
     while (!glfwWindowShouldClose(window)) {
         double currentTime = glfwGetTime();
@@ -116,16 +156,10 @@ int main() {
 
         // Controles principais
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) renderer.processMovement(0, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) renderer.processMovement(1, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) renderer.processMovement(2, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) renderer.processMovement(3, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) renderer.processVerticalMovement(0, deltaTime); // Subir
-        if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) renderer.processVerticalMovement(1, deltaTime); // Descer
-        if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) renderer.processKeyboardRotation(0, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) renderer.processKeyboardRotation(1, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) renderer.processKeyboardRotation(2, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) renderer.processKeyboardRotation(3, deltaTime);
+        // Movimento, portas e animações: na thread de simulação (só as teclas vão para ela) ou aqui
+        SimInput input = readSimInput(window);
+        if (renderer.simulationThreadRunning()) renderer.setSimulationInput(input);
+        else renderer.updateSimulation(deltaTime, input);
 
         // Controles secundários (verificados menos frequentemente)
     if (frameCount % 5 == 0) {
@@ -141,6 +175,27 @@ int main() {
             if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS && !ePressed) { renderer.toggleNearestDoor(); ePressed = true; }
             if (glfwGetKey(window, GLFW_KEY_E) == GLFW_RELEASE) ePressed = false;
 
+            if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !cPressed) { renderer.toggleFrustumCulling(); cPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE) cPressed = false;
+
+            if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS && !rPressed) { renderer.togglePortalCulling(); rPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_R) == GLFW_RELEASE) rPressed = false;
+
+            if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !oPressed) { renderer.toggleOcclusionCulling(); oPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE) oPressed = false;
+
+            // Toggle níveis de detalhe (L)
+            if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !lPressed) { renderer.toggleLod(); lPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE) lPressed = false;
+
+            // Toggle culling por clusters dos meshes grandes (K)
+            if (glfwGetKey(window, GLFW_KEY_K) == GLFW_PRESS && !kPressed) { renderer.toggleClusterCulling(); kPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_K) == GLFW_RELEASE) kPressed = false;
+
+            // Tocar/parar as animações dos modelos (N)
+            if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS && !nPressed) { renderer.toggleAnimations(); nPressed = true; }
+            if (glfwGetKey(window, GLFW_KEY_N) == GLFW_RELEASE) nPressed = false;
+
             // Toggle fullscreen (F11)
             if (glfwGetKey(window, GLFW_KEY_F11) == GLFW_PRESS && !f11Pressed) {
                 f11Pressed = true;
@@ -176,12 +231,40 @@ int main() {
             }
         }
 
-    // Atualizações por frame
-    renderer.updateDoors(deltaTime);
+    // Uploads pendentes (orçamento fixo); posicionar o usuário quando o prédio chegar
+    renderer.pumpAsyncLoads(kUploadBudgetMs);
+    if (!spawned) {
+        LoadStatus status = renderer.loadStatus(building);
+        if (status == LoadStatus::Ready) {
+            // Posicionar o usuário em frente à escada a 3.0 unidades de distância
+            renderer.spawnInFrontOf("escada", 3.0f);
+            spawned = true;
+            std::cout << "Prédio visível em " << (glfwGetTime() - loadStart) * 1000.0 << " ms" << std::endl;
+        } else if (status == LoadStatus::Failed) {
+            std::cerr << "Falha ao carregar o modelo GLTF '" << buildingPath << "'." << std::endl;
+            break;
+        }
+    }
+
     renderer.render();
         glfwSwapBuffers(window);
+
+        // Estatísticas no título da janela (a cada 0.5s)
+        statsFrames++;
+        if (currentTime - lastStatsTime >= 0.5) {
+            const RenderStats& st = renderer.getRenderStats();
+            char title[256];
+            std::snprintf(title, sizeof(title), "GLTF Renderer | %.0f FPS | desenhados %d | culled %d | draws %d | salas %d/%d | ocluidos %d (-%d draws) | %dk tris (%d em LOD, clusters -%d/%d) | carregando %d",
+                          statsFrames / (currentTime - lastStatsTime), st.instancesDrawn, st.instancesCulled, st.drawCalls,
+                          st.roomsVisible, st.roomsTotal, st.instancesOccluded, st.drawsSaved,
+                          st.trianglesDrawn / 1000, st.instancesReduced, st.clustersCulled, st.clustersTested, renderer.pendingAsyncLoads());
+            glfwSetWindowTitle(window, title);
+            lastStatsTime = currentTime;
+            statsFrames = 0;
+        }
     }
 
+    renderer.stopSimulationThread();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file